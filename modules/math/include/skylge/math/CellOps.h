@@ -0,0 +1,78 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___CELL_OPS_INCLUDED
+#define SKYLGE__MATH___CELL_OPS_INCLUDED
+
+#include <stdint.h>
+
+/* The primitives on which Integer and IntegerOps are built, on arrays of
+   cells given by a pointer and a length. A cell holds bits () bits, least
+   significant cell first; the bits above those of a cell need to be zero,
+   and are left zero. The functions neither allocate memory nor check for
+   overlap beyond what is documented; in debug mode they check their other
+   requirements. They use the fastest implementation the processor
+   supports.  */
+class CellOps {
+public:
+  CellOps (void) = delete;
+
+  /* dst[0..an) = a + b, where an >= bn >= 0; returns the carry out of
+     dst[an - 1]. dst may be a or b.  */
+  static bool add (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* dst += src * m, where both have n cells and m < 2^bits (); returns the
+     cell carried out of dst[n - 1].  */
+  static uint64_t addMul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+
+  /* Number of bits of a cell: 64 or, in builds with a different CAL_B, 32
+     or 6.  */
+  static int bits (void);
+
+  /* Returns -1, 0 or 1 if a is less than, equal to or greater than b, where
+     both have n cells.  */
+  static int cmp (const uint64_t* a, const uint64_t* b, int n);
+
+  /* q = src / d, where 0 < d < 2^bits (); returns the remainder. q may be
+     src.  */
+  static uint64_t divRem1 (uint64_t* q, const uint64_t* src, int n, uint64_t d);
+
+  /* dst = src * m, where m < 2^bits (); returns the cell carried out. dst
+     may be src.  */
+  static uint64_t mul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+
+  /* dst = src << count, where n > 0 and 0 < count < bits (); returns the
+     bits shifted out of src[n - 1]. dst may be src or any address above
+     it.  */
+  static uint64_t shl (uint64_t* dst, const uint64_t* src, int n, int count);
+
+  /* dst = src >> count, where n > 0 and 0 < count < bits (). dst may be
+     src or any address below it.  */
+  static void shr (uint64_t* dst, const uint64_t* src, int n, int count);
+
+  /* dst[0..an) = a - b, where an >= bn >= 0; returns the borrow out of
+     dst[an - 1]. dst may be a or b.  */
+  static bool sub (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* dst -= src * m, where both have n cells and m < 2^bits (); returns the
+     cell borrowed out of dst[n - 1].  */
+  static uint64_t subMul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+};
+
+#endif
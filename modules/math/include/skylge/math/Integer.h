@@ -22,15 +22,24 @@
 
 #include <stdint.h>
 
+/* Integers of at most this many cells keep them inside the object instead
+   of allocating them on the heap.  */
+#define INTEGER_INLINE_SIZE 4
+
+class IntegerView;
+
 class Integer {
 private:
   uint64_t* m_buf;
   int m_size;
   int m_max;
   bool m_sign;
+  bool m_external;
+  uint64_t m_inline[INTEGER_INLINE_SIZE];
 
 public:
   explicit Integer (int size);
+  Integer (uint64_t* buf, int size);
   Integer (const Integer& other);
   Integer (Integer&& other);
   virtual ~Integer (void);
@@ -38,6 +47,7 @@ public:
   Integer& operator= (const Integer& other);
   Integer& operator= (Integer&& other);
   Integer& operator= (int64_t val);
+  Integer& operator= (const IntegerView& view);
   operator int64_t () const;
   operator int () const;
 
@@ -60,10 +70,12 @@ private:
 #endif
 
   bool absAdd (const Integer& other);
+  bool absAdd (const IntegerView& other);
   bool absAdd (uint64_t value);
   bool absDec (void);
   bool absInc (void);
   bool absSub (const Integer& other);
+  bool absSub (const IntegerView& other);
   bool absSub (uint64_t value);
   void lshl (Integer& incomingBits, int x);
   void rcl (bool carry);
@@ -72,8 +84,13 @@ private:
   void copy (const Integer& other);
   void copyUsingExistingBuffer (const Integer& other);
   void move (Integer& other);
+  void release (void);
 
+  friend class IntegerBatch;
+  friend class IntegerFile;
+  friend class IntegerFileWriter;
   friend class IntegerOps;
+  friend class IntegerView;
 };
 
 #endif
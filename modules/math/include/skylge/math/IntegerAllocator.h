@@ -0,0 +1,97 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___INTEGER_ALLOCATOR_INCLUDED
+#define SKYLGE__MATH___INTEGER_ALLOCATOR_INCLUDED
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+/* Number of size classes of IntegerPool: sizes up to 8 cells have a class
+   each, larger sizes up to 16384 cells four classes per power of two.  */
+#define INTEGER_POOL_CLASSES 52
+
+/* Provides the buffers of Integers that do not keep their cells inline or
+   in external memory. The allocator in use is process wide. Buffers are
+   released to the allocator in use at that time, so it should be set
+   before any Integer allocates a buffer.  */
+class IntegerAllocator {
+public:
+  virtual ~IntegerAllocator (void);
+
+  /* Returns a buffer of at least size cells, with undefined contents.  */
+  virtual uint64_t* allocate (int size) = 0;
+
+  /* Takes back buf, returned by allocate (size).  */
+  virtual void release (uint64_t* buf, int size) = 0;
+
+  /* Returns the allocator in use, by default IntegerPool::instance ().  */
+  static IntegerAllocator* get (void);
+
+  /* Makes allocator the one in use; NULL selects the default.  */
+  static void set (IntegerAllocator* allocator);
+};
+
+/* The default allocator. Sizes are rounded up to a size class; released
+   buffers are kept on a free list of their class, first in a small cache of
+   the releasing thread, without locking, and then in lists shared by all
+   threads. Buffers are never returned to the system.
+
+   Buffers of at least the huge page threshold are carved from 2 MiB chunks
+   advised to be backed by huge pages (where the system supports this),
+   which saves TLB misses on large operands.  */
+class IntegerPool : public IntegerAllocator {
+private:
+  uint64_t* m_lists[INTEGER_POOL_CLASSES];
+  std::mutex m_mutex;
+  std::atomic<int> m_hugePageThreshold;
+  unsigned char* m_chunk;
+  size_t m_chunkLeft;
+
+  IntegerPool (void);
+
+public:
+  IntegerPool (const IntegerPool&) = delete;
+  IntegerPool (IntegerPool&&) = delete;
+
+  IntegerPool& operator= (const IntegerPool&) = delete;
+  IntegerPool& operator= (IntegerPool&&) = delete;
+
+  virtual uint64_t* allocate (int size);
+  virtual void release (uint64_t* buf, int size);
+
+  int hugePageThreshold (void) const;
+
+  /* Buffers of at least size cells are taken from huge pages; 0 (the
+     default) disables this.  */
+  void setHugePageThreshold (int size);
+
+  static IntegerPool& instance (void);
+
+private:
+  uint64_t* create (int cells);
+  uint64_t* fetch (int sizeClass, int cells, int& count);
+  uint64_t* fromChunk (size_t bytes);
+  void store (int sizeClass, uint64_t* first, uint64_t* last);
+
+  friend class ThreadCache;
+};
+
+#endif
@@ -0,0 +1,56 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___INTEGER_BATCH_INCLUDED
+#define SKYLGE__MATH___INTEGER_BATCH_INCLUDED
+
+#include <stdint.h>
+#include <skylge/math/Integer.h>
+#include <skylge/math/IntegerView.h>
+
+/* A number of independent values of the same size, for the batch versions
+   of add, sub and mul of IntegerOps. The cells are stored interleaved, cell
+   j of every value next to each other, so that one instruction works on
+   the cells of several values at once.  */
+class IntegerBatch {
+private:
+  uint64_t* m_cells;
+  uint64_t* m_signs;
+  const int m_count;
+  const int m_size;
+  const int m_stride;
+
+public:
+  IntegerBatch (int count, int size);
+  IntegerBatch (const IntegerBatch&) = delete;
+  IntegerBatch (IntegerBatch&&) = delete;
+  virtual ~IntegerBatch (void);
+
+  IntegerBatch& operator= (const IntegerBatch&) = delete;
+  IntegerBatch& operator= (IntegerBatch&&) = delete;
+
+  int count (void) const;
+  void get (int index, Integer& dst) const;
+  void set (int index, const IntegerView& value);
+  int size (void) const;
+
+  friend class IntegerOps;
+};
+
+#endif
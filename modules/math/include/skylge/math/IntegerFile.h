@@ -0,0 +1,97 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___INTEGER_FILE_INCLUDED
+#define SKYLGE__MATH___INTEGER_FILE_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <skylge/math/Integer.h>
+#include <skylge/math/IntegerView.h>
+
+/* A file holding an array of Integers, laid out so that it can be mapped
+   into memory and its entries used in place:
+
+     header   64 bytes: the magic "SKYLGEIF", the format version, CAL_B, a
+              byte order mark, the number of entries and the offsets (in
+              bytes) of payload and index.
+     payload  the cells of each entry, m_max cells least significant first,
+              starting at offset 64.
+     index    count + 1 words: word i holds the offset (in cells) of entry i
+              in the payload, with its sign in the most significant bit; the
+              last word holds the total number of cells.
+
+   All words are in the byte order of the machine that wrote the file; byte
+   order and CAL_B are checked when the file is opened.  */
+
+/* Writes an IntegerFile, one entry at a time. The index and header are
+   written by close.  */
+class IntegerFileWriter {
+private:
+  FILE* m_file;
+  uint64_t* m_index;
+  size_t m_count;
+  size_t m_capacity;
+  uint64_t m_cells;
+  bool m_error;
+
+public:
+  explicit IntegerFileWriter (const char* fileName);
+  IntegerFileWriter (const IntegerFileWriter&) = delete;
+  IntegerFileWriter (IntegerFileWriter&&) = delete;
+  virtual ~IntegerFileWriter (void);
+
+  IntegerFileWriter& operator= (const IntegerFileWriter&) = delete;
+  IntegerFileWriter& operator= (IntegerFileWriter&&) = delete;
+
+  void add (const Integer& value);
+  void close (void);
+
+private:
+  bool finish (void);
+};
+
+/* An IntegerFile mapped read-only into memory. The cells of an entry are
+   read in place, without copying, e.g. through view.  */
+class IntegerFile {
+private:
+  const unsigned char* m_data;
+  size_t m_length;
+  const uint64_t* m_payload;
+  const uint64_t* m_index;
+  size_t m_count;
+
+public:
+  explicit IntegerFile (const char* fileName);
+  IntegerFile (const IntegerFile&) = delete;
+  IntegerFile (IntegerFile&&) = delete;
+  virtual ~IntegerFile (void);
+
+  IntegerFile& operator= (const IntegerFile&) = delete;
+  IntegerFile& operator= (IntegerFile&&) = delete;
+
+  const uint64_t* cells (size_t index) const;
+  size_t count (void) const;
+  bool get (Integer& dst, size_t index) const;
+  int length (size_t index) const;
+  bool sign (size_t index) const;
+  IntegerView view (size_t index) const;
+};
+
+#endif
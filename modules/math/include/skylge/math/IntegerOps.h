@@ -20,15 +20,26 @@
 #ifndef SKYLGE__MATH___INTEGER_OPS_INCLUDED
 #define SKYLGE__MATH___INTEGER_OPS_INCLUDED
 
+#include <stdio.h>
+#include <iosfwd>
 #include <string>
 #include <skylge/math/Integer.h>
+#include <skylge/math/IntegerBatch.h>
+#include <skylge/math/IntegerView.h>
+#include <skylge/math/Reciprocal.h>
+
+class Scratch;
 
 class IntegerOps {
 private:
   Integer* m_mulResult;
   Integer* m_remainder;
-  Integer* m_numerator;
   Integer* m_aux;
+  Scratch* m_scratch;
+  bool m_ownsScratch;
+  Reciprocal* m_decimalPowers[16];
+  int m_decimalPowerCount;
+  int m_threads;
   const int m_size;
   const int m_bsize;
 
@@ -42,21 +53,60 @@ public:
   IntegerOps& operator= (IntegerOps&&) = delete;
 
   bool add (Integer& dst, const Integer& src);
+  bool add (Integer& dst, const IntegerView& src);
   bool add (Integer& dst, int value);
+  bool add (IntegerBatch& dst, const IntegerBatch& src);
   Integer createInteger (int64_t value = 0);
+  Reciprocal createReciprocal (const IntegerView& denominator);
   bool dec (Integer& dst);
-  Integer& div (Integer& dst, const Integer& src);
+  size_t decimalLength (const IntegerView& value);
+  Integer& div (Integer& dst, const IntegerView& src);
+  Integer& div (Integer& dst, const Reciprocal& denominator);
+  uint64_t divmod (Integer& dst, uint64_t value);
+  size_t exportBytes (void* dst, const IntegerView& value, int order, size_t size, int endian);
+  bool fromHex (const char* str, size_t length, Integer& dst);
+  bool fromRadix (const char* str, size_t length, int bits, Integer& dst);
+  Integer fromString (const std::string& str);
+  bool importBytes (Integer& dst, const void* src, size_t count, int order, size_t size, int endian);
   bool inc (Integer& dst);
-  Integer& mul (const Integer& srcA, const Integer& srcB);
-  bool sub (Integer& dst, const Integer& src);
-  std::string toString (const Integer& value);
+  uint64_t mod (const IntegerView& src, uint64_t value);
+  Integer& mul (const IntegerView& srcA, const IntegerView& srcB);
+  void mul (IntegerBatch& dst, const IntegerBatch& srcA, const IntegerBatch& srcB);
+  bool mulWord (Integer& dst, uint64_t value);
+  bool parse (const char* str, size_t length, Integer& dst);
+  size_t radixLength (const IntegerView& value, int bits);
+  static bool setIfma (bool enabled);
+  void setThreads (int threads);
+  Integer& sqr (const IntegerView& src);
+  bool sub (Integer& dst, const IntegerView& src);
+  bool sub (IntegerBatch& dst, const IntegerBatch& src);
+  std::string toHex (const IntegerView& value);
+  size_t toChars (char* first, char* last, const IntegerView& value);
+  size_t toRadix (char* dst, const IntegerView& value, int bits);
+  std::string toString (const IntegerView& value);
+  bool write (FILE* stream, const IntegerView& value);
+  std::ostream& write (std::ostream& stream, const IntegerView& value);
 
 private:
-  void baseDiv (Integer& result, const Integer& denominator, int denomBsr, int total);
-  void baseMul (const Integer& srcA, const Integer& srcB);
-  int splitUp (int64_t* parts, Integer& value);
-  bool subtractFromRemainder (const Integer& denominator, int denomBsr, int remainderBsr);
-  void toString (std::string& dst, int64_t* parts, Integer& value);
+  class DigitOutput;
+
+  IntegerOps (int size, Scratch* scratch);
+
+  void baseDiv (Integer& dst, const IntegerView& src);
+  void baseMul (const IntegerView& srcA, const IntegerView& srcB);
+  int decimalPowers (int k);
+  uint64_t divRemWord (uint64_t* q, const uint64_t* src, int n, uint64_t value);
+  void fastMul (const IntegerView& srcA, const IntegerView& srcB);
+  void invert (uint64_t* x, const uint64_t* a, int n, uint64_t* scratch);
+  void mulCells (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+  void newtonDiv (Integer& dst, const Reciprocal& denominator);
+  void newtonDiv (uint64_t* q, uint64_t* num, int nn, const Reciprocal& denominator, uint64_t* scratch);
+  int parseChunks (uint64_t* dst, const uint64_t* chunks, int m, uint64_t* scratch);
+  void sqrCells (uint64_t* dst, const uint64_t* a, int n);
+  void toChars (DigitOutput& dst, const IntegerView& value);
+  void toChars (DigitOutput& dst, uint64_t* x, int n, int k, bool pad, uint64_t* scratch);
+
+  friend class SharedIntegerOps;
 };
 
 #endif
@@ -0,0 +1,56 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___INTEGER_VIEW_INCLUDED
+#define SKYLGE__MATH___INTEGER_VIEW_INCLUDED
+
+#include <stdint.h>
+#include <skylge/math/Integer.h>
+
+/* A read-only value in cells that the view does not own: those of an
+   Integer, of an IntegerFile entry or of any buffer holding cells of CAL_B
+   bits, least significant first. The IntegerOps operations that only read
+   an operand accept views; an Integer converts to one implicitly. The cells
+   need to outlive the view.  */
+class IntegerView {
+private:
+  const uint64_t* m_buf;
+  int m_max;
+  bool m_sign;
+
+public:
+  IntegerView (const Integer& value) : m_buf (value.m_buf), m_max (value.m_max), m_sign (value.m_sign) {
+  }
+  IntegerView (const uint64_t* cells, int length, bool sign);
+
+  int bsr (void) const;
+  const uint64_t* buf (void) const;
+  int max (void) const;
+  bool sign (void) const;
+
+#ifdef DEBUG_MODE
+  int size (void) const;
+#endif
+
+  friend class Integer;
+  friend class IntegerBatch;
+  friend class IntegerOps;
+};
+
+#endif
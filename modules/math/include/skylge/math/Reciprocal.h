@@ -0,0 +1,51 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___RECIPROCAL_INCLUDED
+#define SKYLGE__MATH___RECIPROCAL_INCLUDED
+
+#include <stdint.h>
+
+/* The reciprocal of a denominator, for dividing by the same denominator
+   repeatedly with IntegerOps::div (Integer&, const Reciprocal&). Created by
+   IntegerOps::createReciprocal; holds the denominator d of n cells, shifted
+   left so that its most significant bit is set, followed by the n + 1 cells
+   of floor ((2^(2 n CAL_B) - 1) / d).  */
+class Reciprocal {
+private:
+  uint64_t* m_buf;
+  int m_size;
+  int m_shift;
+  bool m_sign;
+
+public:
+  Reciprocal (const Reciprocal& other);
+  Reciprocal (Reciprocal&& other);
+  virtual ~Reciprocal (void);
+
+  Reciprocal& operator= (const Reciprocal&) = delete;
+  Reciprocal& operator= (Reciprocal&&) = delete;
+
+private:
+  explicit Reciprocal (int size);
+
+  friend class IntegerOps;
+};
+
+#endif
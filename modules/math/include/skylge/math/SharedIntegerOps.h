@@ -0,0 +1,97 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH___SHARED_INTEGER_OPS_INCLUDED
+#define SKYLGE__MATH___SHARED_INTEGER_OPS_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <skylge/math/Integer.h>
+#include <skylge/math/IntegerBatch.h>
+#include <skylge/math/IntegerOps.h>
+#include <skylge/math/IntegerView.h>
+#include <skylge/math/Reciprocal.h>
+
+/* The operations of IntegerOps for Integers of a given size, for use by
+   any number of threads at the same time. Each thread works with an
+   IntegerOps of its own, created when it first uses the object and deleted
+   when the thread exits or the object is destroyed, whichever comes first.
+   The IntegerOps of a thread share their scratch space, which is sized for
+   the largest of them. Unlike those of IntegerOps, the results of mul, sqr
+   and div are returned by value, so they stay valid; those of mul and sqr
+   have as many cells as the product.  */
+class SharedIntegerOps {
+private:
+  struct Instances;
+
+  const int m_size;
+  const uint64_t m_id;
+  std::shared_ptr<Instances> m_instances;
+
+public:
+  explicit SharedIntegerOps (int size);
+  SharedIntegerOps (const SharedIntegerOps&) = delete;
+  SharedIntegerOps (SharedIntegerOps&&) = delete;
+  virtual ~SharedIntegerOps (void);
+
+  SharedIntegerOps& operator= (const SharedIntegerOps&) = delete;
+  SharedIntegerOps& operator= (SharedIntegerOps&&) = delete;
+
+  bool add (Integer& dst, const Integer& src) const;
+  bool add (Integer& dst, const IntegerView& src) const;
+  bool add (Integer& dst, int value) const;
+  bool add (IntegerBatch& dst, const IntegerBatch& src) const;
+  Integer createInteger (int64_t value = 0) const;
+  Reciprocal createReciprocal (const IntegerView& denominator) const;
+  bool dec (Integer& dst) const;
+  size_t decimalLength (const IntegerView& value) const;
+  Integer div (Integer& dst, const IntegerView& src) const;
+  Integer div (Integer& dst, const Reciprocal& denominator) const;
+  uint64_t divmod (Integer& dst, uint64_t value) const;
+  size_t exportBytes (void* dst, const IntegerView& value, int order, size_t size, int endian) const;
+  bool fromHex (const char* str, size_t length, Integer& dst) const;
+  bool fromRadix (const char* str, size_t length, int bits, Integer& dst) const;
+  Integer fromString (const std::string& str) const;
+  bool importBytes (Integer& dst, const void* src, size_t count, int order, size_t size, int endian) const;
+  bool inc (Integer& dst) const;
+  IntegerOps& local (void) const;
+  uint64_t mod (const IntegerView& src, uint64_t value) const;
+  Integer mul (const IntegerView& srcA, const IntegerView& srcB) const;
+  void mul (IntegerBatch& dst, const IntegerBatch& srcA, const IntegerBatch& srcB) const;
+  bool mulWord (Integer& dst, uint64_t value) const;
+  bool parse (const char* str, size_t length, Integer& dst) const;
+  size_t radixLength (const IntegerView& value, int bits) const;
+  int size (void) const;
+  Integer sqr (const IntegerView& src) const;
+  bool sub (Integer& dst, const IntegerView& src) const;
+  bool sub (IntegerBatch& dst, const IntegerBatch& src) const;
+  std::string toHex (const IntegerView& value) const;
+  size_t toChars (char* first, char* last, const IntegerView& value) const;
+  size_t toRadix (char* dst, const IntegerView& value, int bits) const;
+  std::string toString (const IntegerView& value) const;
+  bool write (FILE* stream, const IntegerView& value) const;
+  std::ostream& write (std::ostream& stream, const IntegerView& value) const;
+
+  friend class ThreadIntegerOps;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <skylge/math/CellOps.h>
+#include "defs.h"
+#include "errors.h"
+#include "kernels.h"
+#include "limbs.h"
+
+bool CellOps::add (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+#ifdef DEBUG_MODE
+  if (!(an >= bn && bn >= 0)) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::add] Argument `an' (%d) needs to be at least `bn' (%d), which needs to be non-negative.\n", an, bn);
+  }
+#endif
+
+  return Limbs::add (dst, a, an, b, bn);
+}
+
+uint64_t CellOps::addMul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef DEBUG_MODE
+  if (n < 0 || m > CAL_LMASK[0]) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::addMul1] Argument `n' (%d) needs to be non-negative and `m' (0x%lX) a cell.\n", n, m);
+  }
+#endif
+
+  return Kernels::addMul1 (dst, src, n, m);
+}
+
+int CellOps::bits (void) {
+  return CAL_B;
+}
+
+int CellOps::cmp (const uint64_t* a, const uint64_t* b, const int n) {
+  return Limbs::cmp (a, b, n);
+}
+
+uint64_t CellOps::divRem1 (uint64_t* q, const uint64_t* src, const int n, const uint64_t d) {
+#ifdef DEBUG_MODE
+  if (n < 0 || d == 0 || d > CAL_LMASK[0]) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::divRem1] Argument `n' (%d) needs to be non-negative and `d' (0x%lX) a non-zero cell.\n", n, d);
+  }
+#endif
+
+  return n > 0 ? Limbs::divRem1 (q, src, n, d) : 0;
+}
+
+uint64_t CellOps::mul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef DEBUG_MODE
+  if (n < 0 || m > CAL_LMASK[0]) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::mul1] Argument `n' (%d) needs to be non-negative and `m' (0x%lX) a cell.\n", n, m);
+  }
+#endif
+
+  return Kernels::mul1 (dst, src, n, m);
+}
+
+uint64_t CellOps::shl (uint64_t* dst, const uint64_t* src, const int n, const int count) {
+#ifdef DEBUG_MODE
+  if (n <= 0 || count <= 0 || count >= CAL_B) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::shl] Argument `n' (%d) needs to be positive and `count' (%d) between 0 and %d.\n", n, count, CAL_B);
+  }
+#endif
+
+  return Kernels::shl (dst, src, n, count);
+}
+
+void CellOps::shr (uint64_t* dst, const uint64_t* src, const int n, const int count) {
+#ifdef DEBUG_MODE
+  if (n <= 0 || count <= 0 || count >= CAL_B) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::shr] Argument `n' (%d) needs to be positive and `count' (%d) between 0 and %d.\n", n, count, CAL_B);
+  }
+#endif
+
+  Kernels::shr (dst, src, n, count);
+}
+
+bool CellOps::sub (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+#ifdef DEBUG_MODE
+  if (!(an >= bn && bn >= 0)) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::sub] Argument `an' (%d) needs to be at least `bn' (%d), which needs to be non-negative.\n", an, bn);
+  }
+#endif
+
+  return Limbs::sub (dst, a, an, b, bn);
+}
+
+uint64_t CellOps::subMul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef DEBUG_MODE
+  if (n < 0 || m > CAL_LMASK[0]) {
+    PRINT_MESSAGE_AND_EXIT ("[CellOps::subMul1] Argument `n' (%d) needs to be non-negative and `m' (0x%lX) a cell.\n", n, m);
+  }
+#endif
+
+  return Kernels::subMul1 (dst, src, n, m);
+}
@@ -19,7 +19,11 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdexcept>
+#include <skylge/math/CellOps.h>
 #include <skylge/math/Integer.h>
+#include <skylge/math/IntegerAllocator.h>
+#include <skylge/math/IntegerView.h>
 #include "defs.h"
 #include "errors.h"
 
@@ -33,16 +37,35 @@ bool Integer::operator> (const Integer& other) const;
 bool Integer::operator>= (const Integer& other) const;
 */
 
-Integer::Integer (int size) : m_size (size), m_max (0), m_sign (false) {
+Integer::Integer (int size) : m_size (size), m_max (0), m_sign (false), m_external (false) {
 #ifdef DEBUG_MODE
   if (size < MIN_SIZE || size > MAX_SIZE) {
     PRINT_MESSAGE_AND_EXIT ("[Integer::Integer(int)] The specified size (%d) is out of range. It should be: %d < size < %d.\n", size, MIN_SIZE - 1, MAX_SIZE + 1);
   }
 #endif
 
-  size_t bsize = size << 3;
-  m_buf = (uint64_t*) malloc (bsize);
-  memset (m_buf, 0, bsize);
+  if (size <= INTEGER_INLINE_SIZE) {
+    m_buf = m_inline;
+    memset (m_inline, 0, sizeof (m_inline));
+  } else {
+    m_buf = IntegerAllocator::get ()->allocate (size);
+    memset (m_buf, 0, size << 3);
+  }
+}
+
+/* Uses the size cells at buf, which are not freed, as its buffer, e.g. as
+   destination of IntegerOps operations without copying. Its value is the
+   non-negative number the cells hold. Values assigned to it should have at
+   most size cells; assigning a larger Integer throws std::length_error,
+   leaving it unchanged.  */
+Integer::Integer (uint64_t* buf, int size) : m_buf (buf), m_size (size), m_sign (false), m_external (true) {
+#ifdef DEBUG_MODE
+  if (size < 1) {
+    PRINT_MESSAGE_AND_EXIT ("[Integer::Integer(uint64_t*, int)] The specified size (%d) should be positive.\n", size);
+  }
+#endif
+
+  setMax (size - 1);
 }
 
 Integer::Integer (const Integer& other) {
@@ -54,8 +77,7 @@ Integer::Integer (Integer&& other) {
 }
 
 Integer::~Integer (void) {
-  if (m_buf != NULL)
-    free (m_buf);
+  release ();
 }
 
 Integer& Integer::operator= (const Integer& other) {
@@ -66,8 +88,10 @@ Integer& Integer::operator= (const Integer& other) {
     return *this;
   if (other.m_max <= m_size) {
     copyUsingExistingBuffer (other);
+  } else if (m_external) {
+    throw std::length_error ("Value does not fit in the external cells.");
   } else {
-    free (m_buf);
+    release ();
     copy (other);
   }
 
@@ -83,8 +107,10 @@ Integer& Integer::operator= (Integer&& other) {
     return *this;
   if (other.m_max <= m_size) {
     copyUsingExistingBuffer (other);
+  } else if (m_external) {
+    throw std::length_error ("Value does not fit in the external cells.");
   } else {
-    free (m_buf);
+    release ();
     move (other);
   }
 
@@ -107,7 +133,11 @@ Integer& Integer::operator= (int64_t value) {
   int i = 0;
   while (val != 0) {
     m_buf[i] = val & CAL_LMASK[0];
+#if CAL_B < 64
     val >>= CAL_B;
+#else
+    val = 0;
+#endif
     ++i;
   }
   if (i < m_max) {
@@ -119,16 +149,52 @@ Integer& Integer::operator= (int64_t value) {
   return *this;
 }
 
+/* Copies the value of view; as for an Integer, the buffer is enlarged if
+   the value does not fit, unless it is external.  */
+Integer& Integer::operator= (const IntegerView& view) {
+  VALIDATE_INTEGER ("Integer::operator=(const IntegerView&)", *this, LOC_BEFORE);
+  VALIDATE_INTEGER ("Integer::operator=(const IntegerView&)", view, LOC_BEFORE);
+
+  if (view.m_max > m_size) {
+    if (m_external) {
+      throw std::length_error ("Value does not fit in the external cells.");
+    }
+    release ();
+    m_size = view.m_max;
+    m_max = 0;
+    if (m_size <= INTEGER_INLINE_SIZE) {
+      m_buf = m_inline;
+    } else {
+      m_buf = IntegerAllocator::get ()->allocate (m_size);
+    }
+  }
+  if (view.m_buf != m_buf) {
+    memmove (m_buf, view.m_buf, view.m_max << 3);
+  }
+  if (view.m_max < m_max) {
+    memset (m_buf + view.m_max, 0, m_max - view.m_max << 3);
+  }
+  m_sign = view.m_sign;
+  m_max = view.m_max;
+
+  VALIDATE_INTEGER ("Integer::operator=(const IntegerView&)", *this, LOC_AFTER);
+  return *this;
+}
+
 Integer::operator int64_t () const {
   VALIDATE_INTEGER ("Integer::operator int64_t()", *this, LOC_BEFORE);
 
   int64_t result;
   if (bsr () < 64) {
+#if CAL_B < 64
     result = 0;
     for (int i = m_max - 1; i > -1; --i) {
       result <<= CAL_B;
       result |= (int64_t) m_buf[i];
     }
+#else
+    result = (int64_t) m_buf[0];
+#endif
     if (m_sign)
       result = -result;
   } else {
@@ -142,9 +208,9 @@ Integer::operator int () const {
 
   int result;
 
-#if CAL_B == 32
+#if CAL_B >= 32
 
-  if (m_max < 2 && (m_buf[0] & CAL_SMASK[31]) == 0) {
+  if (m_max < 2 && (m_buf[0] & CAL_LMASK[31]) == 0) {
     result = (int) m_buf[0];
     if (m_sign)
       result = -result;
@@ -177,6 +243,8 @@ bool Integer::operator== (const Integer& other) const {
 
   if (!(m_sign == other.m_sign && m_max == other.m_max))
     return false;
+  if (m_max == 1)
+    return m_buf[0] == other.m_buf[0];
   for (int i = 0; i < m_max; ++i) {
     if (m_buf[i] != other.m_buf[i])
       return false;
@@ -190,32 +258,48 @@ bool Integer::operator!= (const Integer& other) const {
 
 
 bool Integer::absAdd (const Integer& other) {
-  VALIDATE_INTEGER ("Integer::absAdd(const Integer&)", *this, LOC_BEFORE);
-  VALIDATE_INTEGER ("Integer::absAdd(const Integer&)", other, LOC_BEFORE);
 #ifdef DEBUG_MODE
   if (m_size != other.m_size) {
     PRINT_MESSAGE_AND_EXIT ("[Integer::absAdd(const Integer&)] m_size should be equal to other.m_size.\n");
   }
 #endif
+  return absAdd (IntegerView (other));
+}
 
-  bool carry = false;
-  bool otherMaxGreaterThanThisMax = other.m_max > m_max;
-  int max = otherMaxGreaterThanThisMax ? m_max : other.m_max;
-  int i;
+bool Integer::absAdd (const IntegerView& other) {
+  VALIDATE_INTEGER ("Integer::absAdd(const IntegerView&)", *this, LOC_BEFORE);
+  VALIDATE_INTEGER ("Integer::absAdd(const IntegerView&)", other, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (other.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[Integer::absAdd(const IntegerView&)] other.m_max should not exceed m_size.\n");
+  }
+#endif
 
-  for (i = 0; i < max; ++i) {
+  bool carry = false;
+  if (m_max == 1 && other.m_max == 1) {
+    m_buf[0] = calAdd (m_buf[0], other.m_buf[0], carry);
     if (carry) {
-      CAL_CLEAR_CARRY (m_buf[i - 1]);
-      ++m_buf[i];
+      carry = m_size == 1;
+      if (carry) {
+        m_max = m_buf[0] == 0 ? 0 : 1;
+      } else {
+        m_buf[1] = 1;
+        m_max = 2;
+      }
     }
-    m_buf[i] += other.m_buf[i];
-    carry = CAL_CARRY (m_buf[i]);
+    VALIDATE_INTEGER ("Integer::absAdd(const IntegerView&)", *this, LOC_AFTER);
+    return carry;
   }
 
+  bool otherMaxGreaterThanThisMax = other.m_max > m_max;
+  int max = otherMaxGreaterThanThisMax ? m_max : other.m_max;
+  int i = max;
+
+  carry = CellOps::add (m_buf, m_buf, max, other.m_buf, max);
+
   if (otherMaxGreaterThanThisMax) {
 
     if (carry) {
-      CAL_CLEAR_CARRY (m_buf[i - 1]);
       while (i < other.m_max && other.m_buf[i] == CAL_LMASK[0]) {
         ++i;
       }
@@ -241,7 +325,6 @@ bool Integer::absAdd (const Integer& other) {
 
   } else if (carry) {
 
-    CAL_CLEAR_CARRY (m_buf[i - 1]);
     while (i < m_max && m_buf[i] == CAL_LMASK[0]) {
       m_buf[i] = 0;
       ++i;
@@ -257,7 +340,7 @@ bool Integer::absAdd (const Integer& other) {
 
   }
 
-  VALIDATE_INTEGER ("Integer::absAdd(const Integer&)", *this, LOC_AFTER);
+  VALIDATE_INTEGER ("Integer::absAdd(const IntegerView&)", *this, LOC_AFTER);
   return carry;
 }
 
@@ -272,11 +355,10 @@ bool Integer::absAdd (uint64_t value) {
   }
 #endif
 
-  m_buf[0] += value;
-  bool carry = CAL_CARRY (m_buf[0]);
+  bool carry = false;
+  m_buf[0] = calAdd (m_buf[0], value, carry);
   if (carry) {
     int i = 1;
-    CAL_CLEAR_CARRY (m_buf[0]);
     while (i < m_max && m_buf[i] == CAL_LMASK[0]) {
       m_buf[i] = 0;
       ++i;
@@ -304,9 +386,11 @@ bool Integer::absDec (void) {
 #endif
 
   int i = 0;
-  while (m_buf[i] == 0) {
-    m_buf[i] = CAL_LMASK[0];
-    ++i;
+  if (m_buf[0] == 0) {
+    do {
+      m_buf[i] = CAL_LMASK[0];
+      ++i;
+    } while (m_buf[i] == 0);
   }
   --m_buf[i];
   if (m_buf[i] == 0 && i == m_max - 1) {
@@ -322,6 +406,14 @@ bool Integer::absDec (void) {
 bool Integer::absInc (void) {
   VALIDATE_INTEGER ("Integer::absInc(void)", *this, LOC_BEFORE);
 
+  if (m_buf[0] != CAL_LMASK[0]) {
+    ++m_buf[0];
+    if (m_max == 0)
+      m_max = 1;
+    VALIDATE_INTEGER ("Integer::absInc(void)", *this, LOC_AFTER);
+    return false;
+  }
+
   int i = 0;
   while (i < m_size && m_buf[i] == CAL_LMASK[0]) {
     m_buf[i] = 0;
@@ -341,29 +433,46 @@ bool Integer::absInc (void) {
 }
 
 bool Integer::absSub (const Integer& other) {
-  VALIDATE_INTEGER ("Integer::absSub(const Integer&)", *this, LOC_BEFORE);
-  VALIDATE_INTEGER ("Integer::absSub(const Integer&)", other, LOC_BEFORE);
 #ifdef DEBUG_MODE
   if (m_size != other.m_size) {
     PRINT_MESSAGE_AND_EXIT ("[Integer::absSub(const Integer&)] m_size should be equal to other.m_size.\n");
   }
 #endif
+  return absSub (IntegerView (other));
+}
+
+bool Integer::absSub (const IntegerView& other) {
+  VALIDATE_INTEGER ("Integer::absSub(const IntegerView&)", *this, LOC_BEFORE);
+  VALIDATE_INTEGER ("Integer::absSub(const IntegerView&)", other, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (other.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[Integer::absSub(const IntegerView&)] other.m_max should not exceed m_size.\n");
+  }
+#endif
+
+  if (m_max == 1 && other.m_max == 1) {
+    if (m_buf[0] > other.m_buf[0]) {
+      m_buf[0] -= other.m_buf[0];
+    } else if (m_buf[0] < other.m_buf[0]) {
+      m_buf[0] = other.m_buf[0] - m_buf[0];
+      m_sign = !m_sign;
+    } else {
+      m_buf[0] = 0;
+      m_max = 0;
+      m_sign = false;
+    }
+    VALIDATE_INTEGER ("Integer::absSub(const IntegerView&)", *this, LOC_AFTER);
+    return false;
+  }
 
   int i;
   bool carry = false;
 
   if (m_max > other.m_max) {
 
-    for (i = 0; i < other.m_max; ++i) {
-      if (carry) {
-        CAL_CLEAR_CARRY (m_buf[i - 1]);
-        --m_buf[i];
-      }
-      m_buf[i] -= other.m_buf[i];
-      carry = CAL_CARRY (m_buf[i]);
-    }
+    i = other.m_max;
+    carry = CellOps::sub (m_buf, m_buf, i, other.m_buf, i);
     if (carry) {
-      CAL_CLEAR_CARRY (m_buf[i - 1]);
       while (m_buf[i] == 0) {
         m_buf[i] = CAL_LMASK[0];
         ++i;
@@ -375,14 +484,7 @@ bool Integer::absSub (const Integer& other) {
 
   } else if (m_max == other.m_max) {
 
-    for (i = 0; i < m_max; ++i) {
-      if (carry) {
-        CAL_CLEAR_CARRY (m_buf[i - 1]);
-        --m_buf[i];
-      }
-      m_buf[i] -= other.m_buf[i];
-      carry = CAL_CARRY (m_buf[i]);
-    }
+    carry = CellOps::sub (m_buf, m_buf, m_max, other.m_buf, m_max);
     if (carry) {
       i = 0;
       m_sign = !m_sign;
@@ -390,12 +492,10 @@ bool Integer::absSub (const Integer& other) {
         ++i;
       }
       m_buf[i] ^= CAL_LMASK[0];
-      CAL_CLEAR_CARRY (m_buf[i]);
       ++m_buf[i];
       ++i;
       while (i < m_max) {
         m_buf[i] ^= CAL_LMASK[0];
-        CAL_CLEAR_CARRY (m_buf[i]);
         ++i;
       }
     }
@@ -406,17 +506,10 @@ bool Integer::absSub (const Integer& other) {
   } else { /* m_max < other.m_max */
 
     m_sign = !m_sign;
-    for (i = 0; i < m_max; ++i) {
-      if (carry) {
-        CAL_CLEAR_CARRY (m_buf[i - 1]);
-        ++m_buf[i];
-      }
-      m_buf[i] = other.m_buf[i] - m_buf[i];
-      carry = CAL_CARRY (m_buf[i]);
-    }
+    i = m_max;
+    carry = CellOps::sub (m_buf, other.m_buf, i, m_buf, i);
     m_max = other.m_max;
     if (carry) {
-      CAL_CLEAR_CARRY (m_buf[i - 1]);
       while (other.m_buf[i] == 0) {
         m_buf[i] = CAL_LMASK[0];
         ++i;
@@ -441,7 +534,7 @@ bool Integer::absSub (const Integer& other) {
 
   }
 
-  VALIDATE_INTEGER ("Integer::absSub(const Integer&)", *this, LOC_AFTER);
+  VALIDATE_INTEGER ("Integer::absSub(const IntegerView&)", *this, LOC_AFTER);
   return false;
 }
 
@@ -456,13 +549,12 @@ bool Integer::absSub (uint64_t value) {
   }
 #endif
 
-  m_buf[0] -= value;
-  bool carry = CAL_CARRY (m_buf[0]);
+  bool carry = false;
+  m_buf[0] = calSub (m_buf[0], value, carry);
   if (m_max > 1) {
 
     if (carry) {
       int i = 1;
-      CAL_CLEAR_CARRY (m_buf[0]);
       while (m_buf[i] == 0) {
         m_buf[i] = CAL_LMASK[0];
         ++i;
@@ -477,7 +569,6 @@ bool Integer::absSub (uint64_t value) {
     if (carry) {
       m_sign = !m_sign;
       m_buf[0] ^= CAL_LMASK[0];
-      CAL_CLEAR_CARRY (m_buf[0]);
       ++m_buf[0];
     } else if (m_buf[0] == 0) {
       m_max = 0;
@@ -728,15 +819,8 @@ void Integer::shl (int x) {
         z = n;
       else
         z = q + m_max;
-      const int k = CAL_B - r;
-      for (i = z; i > q; --i) {
-        m_buf[i] = m_buf[i - q] << r;
-        m_buf[i] |= m_buf[i - q - 1] >> k;
-        CAL_CLEAR_CARRY (m_buf[i]);
-      }
-      m_buf[q] = m_buf[0] << r;
-      CAL_CLEAR_CARRY (m_buf[q]);
-      --i;
+      CellOps::shl (m_buf + q, m_buf, z - q + 1, r);
+      i = q - 1;
 
     } else {
 
@@ -774,16 +858,9 @@ void Integer::shr (int x) {
       const int oldMax = m_max;
       if (r > 0) {
 
-        --z;
-        const int k = CAL_B - r;
-        for (i = 0; i < z; ++i) {
-          m_buf[i] = m_buf[i + q] >> r;
-          m_buf[i] |= m_buf[i + q + 1] << k;
-          CAL_CLEAR_CARRY (m_buf[i]);
-        }
-        m_buf[z] = m_buf[z + q] >> r;
-        m_max = m_buf[z] > 0 ? z + 1 : z;
-        ++i;
+        CellOps::shr (m_buf, m_buf + q, z, r);
+        m_max = m_buf[z - 1] > 0 ? z : z - 1;
+        i = z;
 
       } else {
 
@@ -813,12 +890,17 @@ bool Integer::sign (void) const {
 
 
 void Integer::copy (const Integer& other) {
+  m_external = false;
   m_size = other.m_size;
   m_sign = other.m_sign;
   m_max = other.m_max;
-  size_t bsize = m_size << 3;
-  m_buf = (uint64_t*) malloc (bsize);
-  memcpy (m_buf, other.m_buf, bsize);
+  if (m_size <= INTEGER_INLINE_SIZE) {
+    m_buf = m_inline;
+  } else {
+    m_buf = IntegerAllocator::get ()->allocate (m_size);
+  }
+  memcpy (m_buf, other.m_buf, m_max << 3);
+  memset (m_buf + m_max, 0, m_size - m_max << 3);
 }
 
 void Integer::copyUsingExistingBuffer (const Integer& other) {
@@ -831,12 +913,26 @@ void Integer::copyUsingExistingBuffer (const Integer& other) {
 }
 
 void Integer::move (Integer& other) {
+  m_external = other.m_external;
   m_size = other.m_size;
   m_sign = other.m_sign;
   m_max = other.m_max;
-  m_buf = other.m_buf;
+  if (other.m_buf == other.m_inline) {
+    /* Inline cells cannot be taken over, so they are copied; other keeps
+       them.  */
+    m_buf = m_inline;
+    memcpy (m_inline, other.m_inline, sizeof (m_inline));
+  } else {
+    m_buf = other.m_buf;
+    other.m_buf = NULL;
+  }
+}
 
-  other.m_buf = NULL;
+/* Releases the buffer, unless it is inline or external or has been moved
+   away.  */
+void Integer::release (void) {
+  if (m_buf != NULL && m_buf != m_inline && !m_external)
+    IntegerAllocator::get ()->release (m_buf, m_size);
 }
 
 
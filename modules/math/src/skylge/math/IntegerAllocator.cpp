@@ -0,0 +1,277 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <skylge/math/IntegerAllocator.h>
+
+/* Largest size (in cells) served from the free lists; larger buffers are
+   simply malloc'ed and freed.  */
+#define MAX_POOL_SIZE 16384
+
+/* Number of buffers of a class a thread cache holds at most, and number of
+   buffers moved at once between a thread cache and the shared lists.  */
+#define CACHE_LIMIT 16
+#define CACHE_BATCH 8
+
+#define HUGE_PAGE_SIZE (2 << 20)
+
+#define CACHE_UNUSED 0
+#define CACHE_OPEN 1
+#define CACHE_CLOSED 2
+
+struct CacheList {
+  uint64_t* head;
+  int count;
+};
+
+/* Flushes the cache of a thread to the shared lists when the thread exits;
+   releases after that go to the shared lists directly.  */
+class ThreadCache {
+public:
+  ~ThreadCache (void);
+
+  void open (void);
+};
+
+static std::atomic<IntegerAllocator*> current (NULL);
+
+static thread_local CacheList cacheLists[INTEGER_POOL_CLASSES];
+static thread_local int cacheState = CACHE_UNUSED;
+static thread_local ThreadCache threadCache;
+
+/* Free buffers are linked through their first cell.  */
+static inline uint64_t* nextOf (const uint64_t* buf) {
+  uint64_t* result;
+  memcpy (&result, buf, sizeof (result));
+  return result;
+}
+
+static inline void setNext (uint64_t* buf, uint64_t* next) {
+  memcpy (buf, &next, sizeof (next));
+}
+
+/* Returns the size class of size, or -1 if there is none, and stores the
+   number of cells of the class in cells: sizes up to 8 have a class each,
+   larger sizes are rounded up to 4, 5, 6 or 7 times a power of two.  */
+static int classOf (int size, int& cells) {
+  if (size <= 8) {
+    cells = size;
+    return size - 1;
+  }
+  if (size > MAX_POOL_SIZE)
+    return -1;
+
+  const int m = size - 1;
+  const int e = 31 - __builtin_clz (m);
+  const int top = m >> e - 2;
+  cells = top + 1 << e - 2;
+  return 4 * e - 8 + top;
+}
+
+/* Returns the cache lists of the calling thread, or NULL if the thread is
+   exiting.  */
+static inline CacheList* threadLists (void) {
+  if (cacheState != CACHE_OPEN) {
+    if (cacheState == CACHE_CLOSED)
+      return NULL;
+    threadCache.open ();
+  }
+  return cacheLists;
+}
+
+
+IntegerAllocator::~IntegerAllocator (void) {
+}
+
+IntegerAllocator* IntegerAllocator::get (void) {
+  IntegerAllocator* result = current.load (std::memory_order_relaxed);
+  return result != NULL ? result : &IntegerPool::instance ();
+}
+
+void IntegerAllocator::set (IntegerAllocator* allocator) {
+  current.store (allocator, std::memory_order_relaxed);
+}
+
+
+IntegerPool::IntegerPool (void) : m_hugePageThreshold (0), m_chunk (NULL), m_chunkLeft (0) {
+  memset (m_lists, 0, sizeof (m_lists));
+}
+
+uint64_t* IntegerPool::allocate (int size) {
+  int cells;
+  const int sizeClass = classOf (size, cells);
+  if (sizeClass < 0)
+    return (uint64_t*) malloc ((size_t) size << 3);
+
+  uint64_t* result;
+  CacheList* lists = threadLists ();
+  if (lists != NULL) {
+    CacheList& list = lists[sizeClass];
+    if (list.head == NULL) {
+      list.head = fetch (sizeClass, cells, list.count);
+    }
+    result = list.head;
+    list.head = nextOf (result);
+    --list.count;
+  } else {
+    int count;
+    result = fetch (sizeClass, cells, count);
+    if (count > 1) {
+      store (sizeClass, nextOf (result), NULL);
+    }
+  }
+  return result;
+}
+
+int IntegerPool::hugePageThreshold (void) const {
+  return m_hugePageThreshold.load (std::memory_order_relaxed);
+}
+
+IntegerPool& IntegerPool::instance (void) {
+  /* Never deleted, so that Integers destroyed at exit can still release
+     their buffers.  */
+  static IntegerPool* pool = new IntegerPool ();
+  return *pool;
+}
+
+void IntegerPool::release (uint64_t* buf, int size) {
+  int cells;
+  const int sizeClass = classOf (size, cells);
+  if (sizeClass < 0) {
+    free (buf);
+    return;
+  }
+
+  CacheList* lists = threadLists ();
+  if (lists != NULL) {
+    CacheList& list = lists[sizeClass];
+    setNext (buf, list.head);
+    list.head = buf;
+    ++list.count;
+    if (list.count > CACHE_LIMIT) {
+      uint64_t* last = buf;
+      for (int i = 1; i < CACHE_BATCH; ++i) {
+        last = nextOf (last);
+      }
+      list.head = nextOf (last);
+      list.count -= CACHE_BATCH;
+      store (sizeClass, buf, last);
+    }
+  } else {
+    store (sizeClass, buf, buf);
+  }
+}
+
+void IntegerPool::setHugePageThreshold (int size) {
+  m_hugePageThreshold.store (size, std::memory_order_relaxed);
+}
+
+/* Returns a new buffer of cells cells. Called with m_mutex locked.  */
+uint64_t* IntegerPool::create (int cells) {
+  const size_t bytes = (size_t) cells << 3;
+  const int threshold = hugePageThreshold ();
+  if (threshold > 0 && cells >= threshold) {
+    uint64_t* result = (uint64_t*) fromChunk (bytes);
+    if (result != NULL)
+      return result;
+  }
+  return (uint64_t*) malloc (bytes);
+}
+
+/* Takes up to CACHE_BATCH buffers of sizeClass from the shared list, or a
+   new one if it is empty, and returns them linked; count is set to their
+   number.  */
+uint64_t* IntegerPool::fetch (int sizeClass, int cells, int& count) {
+  std::lock_guard<std::mutex> lock (m_mutex);
+
+  uint64_t* head = m_lists[sizeClass];
+  if (head == NULL) {
+    head = create (cells);
+    setNext (head, NULL);
+    count = 1;
+    return head;
+  }
+
+  uint64_t* last = head;
+  count = 1;
+  while (count < CACHE_BATCH && nextOf (last) != NULL) {
+    last = nextOf (last);
+    ++count;
+  }
+  m_lists[sizeClass] = nextOf (last);
+  setNext (last, NULL);
+  return head;
+}
+
+/* Returns bytes (a multiple of 8) from the current huge page chunk, starting
+   a new chunk if it has too little left, or NULL if no chunk could be
+   allocated. The rest of a chunk that is too small is left unused. Called
+   with m_mutex locked.  */
+uint64_t* IntegerPool::fromChunk (size_t bytes) {
+  bytes = bytes + 63 & ~(size_t) 63;
+  if (bytes > m_chunkLeft) {
+    void* chunk;
+    if (posix_memalign (&chunk, HUGE_PAGE_SIZE, HUGE_PAGE_SIZE) != 0)
+      return NULL;
+#ifdef MADV_HUGEPAGE
+    madvise (chunk, HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+#endif
+    m_chunk = (unsigned char*) chunk;
+    m_chunkLeft = HUGE_PAGE_SIZE;
+  }
+
+  uint64_t* result = (uint64_t*) m_chunk;
+  m_chunk += bytes;
+  m_chunkLeft -= bytes;
+  return result;
+}
+
+/* Puts the linked buffers first to last (or up to the end of the list if
+   last is NULL) on the shared list of sizeClass.  */
+void IntegerPool::store (int sizeClass, uint64_t* first, uint64_t* last) {
+  std::lock_guard<std::mutex> lock (m_mutex);
+
+  if (last == NULL) {
+    last = first;
+    while (nextOf (last) != NULL) {
+      last = nextOf (last);
+    }
+  }
+  setNext (last, m_lists[sizeClass]);
+  m_lists[sizeClass] = first;
+}
+
+
+ThreadCache::~ThreadCache (void) {
+  IntegerPool& pool = IntegerPool::instance ();
+  for (int i = 0; i < INTEGER_POOL_CLASSES; ++i) {
+    if (cacheLists[i].head != NULL) {
+      pool.store (i, cacheLists[i].head, NULL);
+      cacheLists[i].head = NULL;
+      cacheLists[i].count = 0;
+    }
+  }
+  cacheState = CACHE_CLOSED;
+}
+
+void ThreadCache::open (void) {
+  cacheState = CACHE_OPEN;
+}
@@ -0,0 +1,99 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <skylge/math/IntegerBatch.h>
+#include "batch.h"
+#include "defs.h"
+#include "errors.h"
+
+/* Creates a batch of count values of size cells, all zero.  */
+IntegerBatch::IntegerBatch (int count, int size) : m_count (count), m_size (size), m_stride (count + BATCH_TILE - 1 & ~(BATCH_TILE - 1)) {
+  const size_t bytes = (size_t) m_stride * (size + 1) << 3;
+  void* cells;
+  if (posix_memalign (&cells, 64, bytes) != 0) {
+    throw std::bad_alloc ();
+  }
+  memset (cells, 0, bytes);
+  m_cells = (uint64_t*) cells;
+  m_signs = m_cells + (size_t) m_stride * size;
+}
+
+IntegerBatch::~IntegerBatch (void) {
+  free (m_cells);
+}
+
+int IntegerBatch::count (void) const {
+  return m_count;
+}
+
+/* Copies value number index into dst, which needs to be at least as large
+   as the values of this batch.  */
+void IntegerBatch::get (int index, Integer& dst) const {
+  VALIDATE_INTEGER ("IntegerBatch::get", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (index < 0 || index >= m_count) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerBatch::get] Index out of range (index: %d, count: %d).\n", index, m_count);
+  }
+  if (dst.m_size < m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerBatch::get] Argument `dst' too small (size: %d, batch size: %d).\n", dst.m_size, m_size);
+  }
+#endif
+
+  for (int j = 0; j < m_size; ++j) {
+    dst.m_buf[j] = m_cells[j * m_stride + index];
+  }
+  if (dst.m_max > m_size) {
+    memset (dst.m_buf + m_size, 0, dst.m_max - m_size << 3);
+  }
+  dst.m_sign = m_signs[index] != 0;
+  dst.setMax (m_size - 1);
+
+  VALIDATE_INTEGER ("IntegerBatch::get", dst, LOC_AFTER);
+}
+
+/* Stores value as value number index.  */
+void IntegerBatch::set (int index, const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerBatch::set", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (index < 0 || index >= m_count) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerBatch::set] Index out of range (index: %d, count: %d).\n", index, m_count);
+  }
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerBatch::set] The value of argument `value' does not fit (max: %d, size: %d).\n", value.m_max, m_size);
+  }
+#endif
+
+  int j = 0;
+  while (j < value.m_max) {
+    m_cells[j * m_stride + index] = value.m_buf[j];
+    ++j;
+  }
+  while (j < m_size) {
+    m_cells[j * m_stride + index] = 0;
+    ++j;
+  }
+  m_signs[index] = value.m_sign ? ~(uint64_t) 0 : 0;
+}
+
+int IntegerBatch::size (void) const {
+  return m_size;
+}
@@ -0,0 +1,232 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <skylge/math/IntegerFile.h>
+#include "defs.h"
+#include "errors.h"
+
+#define FORMAT_VERSION 1
+#define HEADER_SIZE 64
+#define SIGN_BIT 0x8000000000000000
+#define BYTE_ORDER_MARK 0x0102030405060708
+
+/* The 64 bytes at the start of the file.  */
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t cellBits;
+  uint64_t byteOrderMark;
+  uint64_t count;
+  uint64_t payloadOffset;
+  uint64_t indexOffset;
+  uint64_t reserved[2];
+};
+
+static_assert (sizeof (Header) == HEADER_SIZE, "Header should be 64 bytes.");
+
+static const char magic[8] = {'S', 'K', 'Y', 'L', 'G', 'E', 'I', 'F'};
+
+IntegerFileWriter::IntegerFileWriter (const char* fileName) : m_index (NULL), m_count (0), m_capacity (0), m_cells (0), m_error (false) {
+  m_file = fopen (fileName, "wb");
+  if (m_file == NULL) {
+    throw std::runtime_error ("Could not create file.");
+  }
+
+  /* The header is filled in by close.  */
+  const char zeros[HEADER_SIZE] = {0};
+  m_error = fwrite (zeros, 1, HEADER_SIZE, m_file) != HEADER_SIZE;
+}
+
+IntegerFileWriter::~IntegerFileWriter (void) {
+  if (m_file != NULL) {
+    finish ();
+  }
+  free (m_index);
+}
+
+void IntegerFileWriter::add (const Integer& value) {
+  VALIDATE_INTEGER ("IntegerFileWriter::add(const Integer&)", value, LOC_BEFORE);
+  if (m_file == NULL) {
+    throw std::runtime_error ("File already closed.");
+  }
+
+  if (m_count + 1 >= m_capacity) {
+    m_capacity = m_capacity > 0 ? 2 * m_capacity : 1024;
+    m_index = (uint64_t*) realloc (m_index, m_capacity << 3);
+  }
+  m_index[m_count++] = m_cells | (value.m_sign ? SIGN_BIT : 0);
+  m_error |= fwrite (value.m_buf, 8, value.m_max, m_file) != (size_t) value.m_max;
+  m_cells += value.m_max;
+}
+
+/* Writes the index and the header and closes the file; throws if anything
+   could not be written.  */
+void IntegerFileWriter::close (void) {
+  if (m_file == NULL) {
+    throw std::runtime_error ("File already closed.");
+  }
+  if (!finish ()) {
+    throw std::runtime_error ("Could not write file.");
+  }
+}
+
+/* As close, returning false instead of throwing.  */
+bool IntegerFileWriter::finish (void) {
+  if (m_count + 1 > m_capacity) {
+    m_capacity = m_count + 1;
+    m_index = (uint64_t*) realloc (m_index, m_capacity << 3);
+  }
+  m_index[m_count] = m_cells;
+
+  Header header;
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, magic, 8);
+  header.version = FORMAT_VERSION;
+  header.cellBits = CAL_B;
+  header.byteOrderMark = BYTE_ORDER_MARK;
+  header.count = m_count;
+  header.payloadOffset = HEADER_SIZE;
+  header.indexOffset = HEADER_SIZE + (m_cells << 3);
+
+  m_error |= fwrite (m_index, 8, m_count + 1, m_file) != m_count + 1;
+  m_error |= fseek (m_file, 0, SEEK_SET) != 0;
+  m_error |= fwrite (&header, sizeof (header), 1, m_file) != 1;
+  m_error |= fclose (m_file) != 0;
+  m_file = NULL;
+  return !m_error;
+}
+
+IntegerFile::IntegerFile (const char* fileName) {
+  const int fd = open (fileName, O_RDONLY);
+  if (fd == -1) {
+    throw std::runtime_error ("Could not open file.");
+  }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size < HEADER_SIZE + 8) {
+    ::close (fd);
+    throw std::runtime_error ("Not an integer file.");
+  }
+  m_length = st.st_size;
+  void* data = mmap (NULL, m_length, PROT_READ, MAP_SHARED, fd, 0);
+  ::close (fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error ("Could not map file.");
+  }
+  m_data = (const unsigned char*) data;
+
+  /* Checks the structure, so that the accessors need not: the index is
+     ascending and refers to cells within the payload only, and each entry
+     is normalised, its top cell being non-zero and (for CAL_B < 64) all its
+     cells less than 2^CAL_B.  */
+  const Header* header = (const Header*) m_data;
+  bool valid = memcmp (header->magic, magic, 8) == 0 && header->version == FORMAT_VERSION && header->cellBits == CAL_B && header->byteOrderMark == BYTE_ORDER_MARK;
+  valid = valid && header->payloadOffset == HEADER_SIZE && header->indexOffset % 8 == 0 && header->indexOffset >= HEADER_SIZE && header->indexOffset < m_length;
+  valid = valid && header->count == (m_length - header->indexOffset) / 8 - 1 && (m_length - header->indexOffset) % 8 == 0;
+  if (valid) {
+    m_count = header->count;
+    m_payload = (const uint64_t*) (m_data + HEADER_SIZE);
+    m_index = (const uint64_t*) (m_data + header->indexOffset);
+    valid = m_index[m_count] == (header->indexOffset - HEADER_SIZE) / 8;
+    for (size_t i = 0; valid && i < m_count; ++i) {
+      const uint64_t start = m_index[i] & ~SIGN_BIT;
+      const uint64_t end = m_index[i + 1] & ~SIGN_BIT;
+      valid = start <= end && end - start <= INT32_MAX && (end > start || (m_index[i] & SIGN_BIT) == 0);
+      valid = valid && (end == start || m_payload[end - 1] != 0);
+#if CAL_B < 64
+      for (uint64_t j = start; valid && j < end; ++j) {
+        valid = (m_payload[j] & ~CAL_LMASK[0]) == 0;
+      }
+#endif
+    }
+  }
+  if (!valid) {
+    munmap ((void*) m_data, m_length);
+    throw std::runtime_error ("Not an integer file.");
+  }
+}
+
+IntegerFile::~IntegerFile (void) {
+  munmap ((void*) m_data, m_length);
+}
+
+/* Returns the cells of entry index, least significant first; the most
+   significant one is non-zero.  */
+const uint64_t* IntegerFile::cells (const size_t index) const {
+#ifdef DEBUG_MODE
+  if (index >= m_count) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerFile::cells(size_t)] Index %lu out of range (count: %lu).\n", (unsigned long) index, (unsigned long) m_count);
+  }
+#endif
+  return m_payload + (m_index[index] & ~SIGN_BIT);
+}
+
+size_t IntegerFile::count (void) const {
+  return m_count;
+}
+
+/* Copies entry index into dst; returns false, leaving dst unchanged, if it
+   has more cells than dst.  */
+bool IntegerFile::get (Integer& dst, const size_t index) const {
+  VALIDATE_INTEGER ("IntegerFile::get(Integer&, size_t)", dst, LOC_BEFORE);
+
+  const int n = length (index);
+  if (n > dst.m_size)
+    return false;
+  memcpy (dst.m_buf, cells (index), n << 3);
+  if (n < dst.m_max) {
+    memset (dst.m_buf + n, 0, dst.m_max - n << 3);
+  }
+  dst.m_max = n;
+  dst.m_sign = sign (index);
+
+  VALIDATE_INTEGER ("IntegerFile::get(Integer&, size_t)", dst, LOC_AFTER);
+  return true;
+}
+
+/* Returns the number of cells of entry index.  */
+int IntegerFile::length (const size_t index) const {
+#ifdef DEBUG_MODE
+  if (index >= m_count) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerFile::length(size_t)] Index %lu out of range (count: %lu).\n", (unsigned long) index, (unsigned long) m_count);
+  }
+#endif
+  return (int) ((m_index[index + 1] & ~SIGN_BIT) - (m_index[index] & ~SIGN_BIT));
+}
+
+bool IntegerFile::sign (const size_t index) const {
+#ifdef DEBUG_MODE
+  if (index >= m_count) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerFile::sign(size_t)] Index %lu out of range (count: %lu).\n", (unsigned long) index, (unsigned long) m_count);
+  }
+#endif
+  return (m_index[index] & SIGN_BIT) != 0;
+}
+
+/* Returns entry index as a view of its cells in the mapped file, valid as
+   long as this IntegerFile exists.  */
+IntegerView IntegerFile::view (const size_t index) const {
+  return IntegerView (cells (index), length (index), sign (index));
+}
@@ -17,44 +17,98 @@
    You should have received a copy of the GNU General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ostream>
 #include <stdexcept>
+#include <skylge/math/CellOps.h>
 #include <skylge/math/IntegerOps.h>
+#include "batch.h"
 #include "defs.h"
 #include "errors.h"
+#include "ifma.h"
+#include "limbs.h"
+#include "Ntt.h"
+#include "Scratch.h"
+#include "TaskPool.h"
 
-#define MAX_SIZE 8192
-#define MIN_SIZE 2
+static const uint64_t one = 1;
 
-IntegerOps::IntegerOps (int size) : m_size (size), m_bsize (m_size * CAL_B) {
+#if CAL_B < 64
+/* Stores value in dst, one cell per CAL_B bits; returns the number of cells
+   used.  */
+static int wordToCells (uint64_t* dst, uint64_t value) {
+  int n = 0;
+  for (; value > 0; value >>= CAL_B) {
+    dst[n++] = value & CAL_LMASK[0];
+  }
+  return n;
+}
+#endif
+
+/* Returns true if r[0..rn) < a[0..n), where rn >= n.  */
+static bool lessThan (const uint64_t* r, const int rn, const uint64_t* a, const int n) {
+  for (int i = n; i < rn; ++i) {
+    if (r[i] != 0)
+      return false;
+  }
+  return CellOps::cmp (r, a, n) < 0;
+}
+
+IntegerOps::IntegerOps (int size) : IntegerOps (size, nullptr) {
+}
+
+/* Uses scratch, which should suffice for size and outlive the object, if
+   not null.  */
+IntegerOps::IntegerOps (int size, Scratch* scratch) : m_size (size), m_bsize (m_size * CAL_B) {
 #ifdef DEBUG_MODE
-  if (size < MIN_SIZE || size > MAX_SIZE) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::IntegerOps(int)] The specified size (%d) is out of range. It should be: %d < size < %d.\n", size, MIN_SIZE - 1, MAX_SIZE + 1);
+  if (size < OPS_MIN_SIZE || size > OPS_MAX_SIZE) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::IntegerOps(int)] The specified size (%d) is out of range. It should be: %d < size < %d.\n", size, OPS_MIN_SIZE - 1, OPS_MAX_SIZE + 1);
+  }
+  if (scratch != nullptr && scratch->size () < size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::IntegerOps(int, Scratch*)] The scratch space is too small (%d) for size %d.\n", scratch->size (), size);
   }
 #endif
 
   m_mulResult = new Integer (2 * size);
   m_remainder = new Integer (size);
-  m_numerator = new Integer (size);
   m_aux = new Integer (size);
+  m_ownsScratch = scratch == nullptr;
+  m_scratch = m_ownsScratch ? new Scratch (size) : scratch;
+  m_decimalPowerCount = 0;
+  m_threads = 1;
 }
 
 IntegerOps::~IntegerOps (void) {
   delete m_mulResult;
   delete m_remainder;
-  delete m_numerator;
   delete m_aux;
+  if (m_ownsScratch) {
+    delete m_scratch;
+  }
+  for (int i = 0; i < m_decimalPowerCount; ++i) {
+    delete m_decimalPowers[i];
+  }
 }
 
 bool IntegerOps::add (Integer& dst, const Integer& src) {
-  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const Integer&)", dst, LOC_BEFORE);
-  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const Integer&)", src, LOC_BEFORE);
 #ifdef DEBUG_MODE
   if (!(dst.m_size == m_size && src.m_size == m_size)) {
     PRINT_MESSAGE_AND_EXIT ("[IntegerOps::add(Integer&, const Integer&)] The two arguments `dst' and `src' need to be of size %d.\n", m_size);
   }
 #endif
+  return add (dst, IntegerView (src));
+}
+
+bool IntegerOps::add (Integer& dst, const IntegerView& src) {
+  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const IntegerView&)", dst, LOC_BEFORE);
+  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const IntegerView&)", src, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (!(dst.m_size == m_size && src.m_max <= m_size)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::add(Integer&, const IntegerView&)] Argument `dst' needs to be of size %d and `src' to have at most as many cells.\n", m_size);
+  }
+#endif
 
   bool carry;
   if (src.m_max > 0) {
@@ -71,7 +125,7 @@ bool IntegerOps::add (Integer& dst, const Integer& src) {
     carry = false;
   }
 
-  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const Integer&)", dst, LOC_AFTER);
+  VALIDATE_INTEGER ("IntegerOps::add(Integer&, const IntegerView&)", dst, LOC_AFTER);
   return carry;
 }
 
@@ -117,64 +171,56 @@ bool IntegerOps::add (Integer& dst, int value) {
   return carry;
 }
 
-void IntegerOps::baseDiv (Integer& result, const Integer& denominator, const int denomBsr, int total) {
-  while (total > 0) {
-    const int remainderBsr = m_remainder->bsr ();
-    if (remainderBsr == 0) {
-      int i = m_bsize - m_numerator->bsr ();
-      if (i > total)
-        i = total;
-      result.lshl (*m_numerator, i);
-      total -= i;
-      /* m_numerator's most significant bit set or no more bits left (total=0).  */
-    }
-    if (total > 0) {
-      int i = remainderBsr < denomBsr ? denomBsr - remainderBsr : 1;
-      if (i <= total) {
-        result.shl (i - 1);
-        m_remainder->lshl (*m_numerator, i);
-        bool bit = subtractFromRemainder (denominator, denomBsr, remainderBsr + i);
-        result.rcl (bit);
-        total -= i;
-      } else {
-        result.shl (total);
-        m_remainder->lshl (*m_numerator, total);
-        total = 0;
-      }
-    }
+/* Adds each value of src to the value of dst with the same index; returns
+   true if any of the sums does not fit, in which case that value of dst
+   holds its lower m_size cells. Unlike in an Integer, a zero result is
+   never negative.  */
+bool IntegerOps::add (IntegerBatch& dst, const IntegerBatch& src) {
+#ifdef DEBUG_MODE
+  if (!(dst.m_size == m_size && src.m_size == m_size && dst.m_count == src.m_count)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::add(IntegerBatch&, const IntegerBatch&)] Arguments `dst' and `src' need to hold as many values, of size %d.\n", m_size);
   }
+#endif
+
+  return Batch::add (dst.m_cells, dst.m_signs, dst.m_cells, dst.m_signs, src.m_cells, src.m_signs, m_size, dst.m_stride, false);
 }
 
-/* TODO: Ook testen in CAL_B=32 conditie.  */
-void IntegerOps::baseMul (const Integer& srcA, const Integer& srcB) {
-  for (int i = 0; i < srcA.m_max; ++i) {
-    m_mulResult->m_buf[i] += srcA.m_buf[i] * srcB.m_buf[0];
-    m_mulResult->m_buf[i + 1] = m_mulResult->m_buf[i] >> CAL_B;
-    CAL_CLEAR_CARRY (m_mulResult->m_buf[i]);
-  }
-
-  int k = srcA.m_max;
-  for (int i = 1; i < srcB.m_max; ++i) {
-    if (srcB.m_buf[i] > 0) {
-      k = i;
-      uint64_t high, low = 0;
-      for (int j = 0; j < srcA.m_max; ++j) {
-        low += srcA.m_buf[j] * srcB.m_buf[i];
-        high = low >> CAL_B;
-        CAL_CLEAR_CARRY (low);
-        m_mulResult->m_buf[k] += low;
-        if (CAL_CARRY (m_mulResult->m_buf[k])) {
-          CAL_CLEAR_CARRY (m_mulResult->m_buf[k]);
-          ++m_mulResult->m_buf[k + 1];
-        }
-        low = high;
-        ++k;
-      }
-      m_mulResult->m_buf[k] += low;
-    }
+/* Divides |dst| by |src|, where dst.m_max >= src.m_max >= 2: stores the
+   quotient in dst and the remainder in m_remainder, which is zero on entry.
+   Both operands are shifted left so that the most significant bit of the
+   divisor is set, as required by Limbs::div.  */
+void IntegerOps::baseDiv (Integer& dst, const IntegerView& src) {
+  const int nn = dst.m_max;
+  const int dn = src.m_max;
+  uint64_t* n = m_scratch->div ();
+  uint64_t* d = n + nn + 1;
+  const int bits = calClz (src.m_buf[dn - 1]);
+  if (bits > 0) {
+    n[nn] = CellOps::shl (n, dst.m_buf, nn, bits);
+    CellOps::shl (d, src.m_buf, dn, bits);
+  } else {
+    memcpy (n, dst.m_buf, nn << 3);
+    n[nn] = 0;
+    memcpy (d, src.m_buf, dn << 3);
   }
+
+  memset (dst.m_buf, 0, nn << 3);
+  Limbs::div (dst.m_buf, n, nn, d, dn, d + dn);
+  dst.setMax (nn - dn);
+
+  if (bits > 0) {
+    CellOps::shr (m_remainder->m_buf, n, dn, bits);
+  } else {
+    memcpy (m_remainder->m_buf, n, dn << 3);
+  }
+  m_remainder->setMax (dn - 1);
+}
+
+/* TODO: Ook testen in CAL_B=32 conditie.  */
+void IntegerOps::baseMul (const IntegerView& srcA, const IntegerView& srcB) {
+  Limbs::mulBasecase (m_mulResult->m_buf, srcA.m_buf, srcA.m_max, srcB.m_buf, srcB.m_max);
   m_mulResult->m_sign = srcA.m_sign ^ srcB.m_sign;
-  m_mulResult->setMax (k);
+  m_mulResult->setMax (srcA.m_max + srcB.m_max - 1);
 }
 
 Integer IntegerOps::createInteger (int64_t value) {
@@ -183,6 +229,53 @@ Integer IntegerOps::createInteger (int64_t value) {
   return result;
 }
 
+/* The reciprocal is first approximated by invert and then made exact, which
+   costs one more multiplication.  */
+Reciprocal IntegerOps::createReciprocal (const IntegerView& denominator) {
+  VALIDATE_INTEGER ("IntegerOps::createReciprocal(const IntegerView&)", denominator, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (denominator.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::createReciprocal(const IntegerView&)] Argument `denominator' needs to have at most %d cells.\n", m_size);
+  }
+#endif
+
+  if (denominator.m_max == 0) {
+    throw std::runtime_error ("Division by zero.");
+  }
+
+  const int n = denominator.m_max;
+  Reciprocal result (n);
+  uint64_t* a = result.m_buf;
+  uint64_t* x = a + n;
+  result.m_sign = denominator.m_sign;
+  result.m_shift = calClz (denominator.m_buf[n - 1]);
+  if (result.m_shift > 0) {
+    CellOps::shl (a, denominator.m_buf, n, result.m_shift);
+  } else {
+    memcpy (a, denominator.m_buf, n << 3);
+  }
+
+  /* Single cell denominators are divided by directly.  */
+  if (n > 1) {
+    uint64_t* p = m_scratch->newton ();
+    invert (x, a, n, p);
+    mulCells (p, x, n + 1, a, n);
+    while (p[2 * n] != 0) {
+      CellOps::sub (x, x, n + 1, &one, 1);
+      CellOps::sub (p, p, 2 * n + 1, a, n);
+    }
+    /* p = 2^(2 n CAL_B) - 1 - a x  */
+    for (int i = 0; i < 2 * n; ++i) {
+      p[i] = ~p[i] & CAL_LMASK[0];
+    }
+    while (!lessThan (p, 2 * n, a, n)) {
+      CellOps::add (x, x, n + 1, &one, 1);
+      CellOps::sub (p, p, 2 * n, a, n);
+    }
+  }
+  return result;
+}
+
 bool IntegerOps::dec (Integer& dst) {
   VALIDATE_INTEGER ("IntegerOps::dec(Integer&)", dst, LOC_BEFORE);
 #ifdef DEBUG_MODE
@@ -208,48 +301,117 @@ bool IntegerOps::dec (Integer& dst) {
   return carry;
 }
 
-/*
-TODO:
-Er is er een probleem als we gaan delen met reële getallen. Als de meest
-significante bit van de noemer is gezet en de teller heeft ook de meest signifi-
-cante bit gezet, maar is toch kleiner, dan verdwijnt hier dat getal in de rest
-en is de berekening klaar. Bij reële getallen, echter, delen we dan door, d.w.z.
-er schuift een nul het resultaat in en de remainder wordt één naar links gescho-
-ven: de meest significante bit valt er in de huidige situatie dus vanaf en we
-verliezen informatie als dat een 1 was....
-Daarvoor moet de grootte van m_remainder met 1 worden verhoogd, maar Integer:lshl
-accepteert dat nu niet: dat moet dus worden aangepast.
- */
-/* Modifies: m_aux, m_remainder, m_numerator.  */
-Integer& IntegerOps::div (Integer& dst, const Integer& src) {
-  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const Integer&)", dst, LOC_BEFORE);
-  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const Integer&)", src, LOC_BEFORE);
+/* Returns the number of characters toChars writes for value. The decimal
+   logarithm of value, estimated from its top cells, settles this unless it
+   is very close to an integer e; then value is compared with 10^e.  */
+size_t IntegerOps::decimalLength (const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerOps::decimalLength(const IntegerView&)", value, LOC_BEFORE);
 #ifdef DEBUG_MODE
-  if (!(dst.m_size == m_size && src.m_size == m_size)) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::div(Integer&, const Integer&)] The two arguments `dst' and `src' need to be of size %d.\n", m_size);
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::decimalLength(const IntegerView&)] Argument `value' needs to have at most %d cells.\n", m_size);
   }
 #endif
 
-  if (dst.m_max > 0 && src.m_max > 0) {
+  if (value.m_max == 0)
+    return 1;
+
+  int i = value.m_max - 1;
+  long double top = value.m_buf[i];
+  while (i > 0 && top < 0x1p80L) {
+    top = ldexpl (top, CAL_B) + value.m_buf[--i];
+  }
+  const long double log = log10l (top) + (long double) i * CAL_B * 0.301029995663981195213738894724493027L;
+  size_t digits = (size_t) log + 1;
+
+  const long double e = floorl (log + 0.5L);
+  if (fabsl (log - e) < 1e-9L) {
+    /* p = 10^e, by squaring and multiplying by 10 for the bits of e from
+       the most significant one.  */
+    const int maxCells = value.m_max + 1;
+    uint64_t* p = m_scratch->newton ();
+    uint64_t* t = p + maxCells + 1;
+    int pn = 1;
+    p[0] = 1;
+    const int exponent = (int) e;
+    for (int bit = 31 - __builtin_clz (exponent | 1); bit > -1; --bit) {
+      Limbs::sqr (t, p, pn, m_scratch->mul ());
+      pn *= 2;
+      while (pn > 1 && t[pn - 1] == 0) {
+        --pn;
+      }
+      if (pn > maxCells)
+        break;
+      memcpy (p, t, pn << 3);
+      if ((exponent >> bit & 1) != 0) {
+        p[pn] = CellOps::mul1 (p, p, pn, 10);
+        pn += p[pn] != 0;
+      }
+    }
+    const bool less = pn > maxCells || pn > value.m_max || pn == value.m_max && CellOps::cmp (value.m_buf, p, pn) < 0;
+    digits = (size_t) e + !less;
+  }
+  return digits + value.m_sign;
+}
+
+/* Creates the powers 10^(18 2^i) for i <= k, as far as they fit in m_size
+   cells, and returns the highest i for which the power exists.  */
+int IntegerOps::decimalPowers (const int k) {
+  if (m_decimalPowerCount == 0) {
+    m_decimalPowers[0] = new Reciprocal (createReciprocal (createInteger (1000000000000000000)));
+    m_decimalPowerCount = 1;
+  }
+  if (m_decimalPowerCount <= k) {
+    const Reciprocal& last = *m_decimalPowers[m_decimalPowerCount - 1];
+    Integer power = createInteger ();
+    if (last.m_shift > 0) {
+      CellOps::shr (power.m_buf, last.m_buf, last.m_size, last.m_shift);
+    } else {
+      memcpy (power.m_buf, last.m_buf, last.m_size << 3);
+    }
+    power.setMax (last.m_size - 1);
+
+    /* Squared apart from m_mulResult, which may hold the value being
+       converted.  */
+    Integer square (2 * m_size);
+    while (m_decimalPowerCount <= k) {
+      sqrCells (square.m_buf, power.m_buf, power.m_max);
+      square.setMax (2 * power.m_max - 1);
+      if (square.m_max > m_size)
+        break;
+      power = square;
+      m_decimalPowers[m_decimalPowerCount++] = new Reciprocal (createReciprocal (power));
+    }
+  }
+  return k < m_decimalPowerCount ? k : m_decimalPowerCount - 1;
+}
 
-    const int numeratorBsr = dst.bsr ();
-    const int denominatorBsr = src.bsr ();
+/* Modifies: m_remainder.  */
+Integer& IntegerOps::div (Integer& dst, const IntegerView& src) {
+  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const IntegerView&)", dst, LOC_BEFORE);
+  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const IntegerView&)", src, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (!(dst.m_size == m_size && src.m_max <= m_size)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::div(Integer&, const IntegerView&)] Argument `dst' needs to be of size %d and `src' to have at most as many cells.\n", m_size);
+  }
+#endif
 
-    if (denominatorBsr <= numeratorBsr) {
-      *m_numerator = dst;
-      m_numerator->shl (m_bsize - numeratorBsr);
+  if (dst.m_max > 0 && src.m_max > 0) {
+
+    if (dst.m_max >= src.m_max) {
+      const bool numeratorSign = dst.m_sign;
+      const bool denominatorSign = src.m_sign;
       *m_remainder = 0;
-      dst = 0;
 
-      m_remainder->lshl (*m_numerator, denominatorBsr);
-      bool bit = subtractFromRemainder (src, denominatorBsr, denominatorBsr);
-      dst.rcl (bit);
-      baseDiv (dst, src, denominatorBsr, numeratorBsr - denominatorBsr);
+      if (src.m_max == 1) {
+        m_remainder->m_buf[0] = CellOps::divRem1 (dst.m_buf, dst.m_buf, dst.m_max, src.m_buf[0]);
+        m_remainder->setMax (0);
+        dst.setMax (dst.m_max - 1);
+      } else {
+        baseDiv (dst, src);
+      }
 
-      if (dst.m_max > 0)
-        dst.m_sign = m_numerator->m_sign ^ src.m_sign;
-      if (m_remainder->m_max > 0)
-        m_remainder->m_sign = m_numerator->m_sign;
+      dst.m_sign = dst.m_max > 0 && (numeratorSign ^ denominatorSign);
+      m_remainder->m_sign = m_remainder->m_max > 0 && numeratorSign;
     } else {
       *m_remainder = dst;
       dst = 0;
@@ -263,10 +425,398 @@ Integer& IntegerOps::div (Integer& dst, const Integer& src) {
     *m_remainder = 0;
   }
 
-  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const Integer&)", *m_remainder, LOC_AFTER);
+  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const IntegerView&)", *m_remainder, LOC_AFTER);
   return *m_remainder;
 }
 
+/* Modifies: m_remainder.  */
+Integer& IntegerOps::div (Integer& dst, const Reciprocal& denominator) {
+  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const Reciprocal&)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (!(dst.m_size == m_size && denominator.m_size <= m_size)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::div(Integer&, const Reciprocal&)] Argument `dst' needs to be of size %d and `denominator' may not be larger.\n", m_size);
+  }
+#endif
+
+  const int n = denominator.m_size;
+  if (dst.m_max >= n) {
+    const bool numeratorSign = dst.m_sign;
+    *m_remainder = 0;
+
+    if (n == 1) {
+      m_remainder->m_buf[0] = CellOps::divRem1 (dst.m_buf, dst.m_buf, dst.m_max, denominator.m_buf[0] >> denominator.m_shift);
+      m_remainder->setMax (0);
+      dst.setMax (dst.m_max - 1);
+    } else {
+      newtonDiv (dst, denominator);
+    }
+
+    dst.m_sign = dst.m_max > 0 && (numeratorSign ^ denominator.m_sign);
+    m_remainder->m_sign = m_remainder->m_max > 0 && numeratorSign;
+  } else {
+    *m_remainder = dst;
+    dst = 0;
+  }
+
+  VALIDATE_INTEGER ("IntegerOps::div(Integer&, const Reciprocal&)", *m_remainder, LOC_AFTER);
+  return *m_remainder;
+}
+
+/* Divides dst by value, rounding towards zero like div, and returns the
+   absolute value of the remainder.  */
+uint64_t IntegerOps::divmod (Integer& dst, const uint64_t value) {
+  VALIDATE_INTEGER ("IntegerOps::divmod(Integer&, uint64_t)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (dst.m_size != m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::divmod(Integer&, uint64_t)] Argument `dst' needs to be of size %d.\n", m_size);
+  }
+#endif
+
+  if (value == 0) {
+    throw std::runtime_error ("Division by zero.");
+  }
+
+  uint64_t remainder = 0;
+  if (dst.m_max > 0) {
+    remainder = divRemWord (dst.m_buf, dst.m_buf, dst.m_max, value);
+    dst.setMax (dst.m_max - 1);
+    dst.m_sign = dst.m_max > 0 && dst.m_sign;
+  }
+
+  VALIDATE_INTEGER ("IntegerOps::divmod(Integer&, uint64_t)", dst, LOC_AFTER);
+  return remainder;
+}
+
+/* q[0..n) = src / value, where value > 0; returns the remainder. q may be src,
+   or nullptr if only the remainder is needed. A single cell value is divided
+   by with a precomputed inverse, a larger one (only possible if CAL_B < 64)
+   with Limbs::div.  */
+uint64_t IntegerOps::divRemWord (uint64_t* q, const uint64_t* src, const int n, const uint64_t value) {
+#if CAL_B < 64
+  if (value > CAL_LMASK[0]) {
+    uint64_t* d = m_scratch->div ();
+    const int dn = wordToCells (d, value);
+
+    uint64_t remainder = 0;
+    if (n < dn) {
+      for (int i = n - 1; i > -1; --i) {
+        remainder = remainder << CAL_B | src[i];
+      }
+      if (q != nullptr) {
+        memset (q, 0, n << 3);
+      }
+      return remainder;
+    }
+
+    uint64_t* num = d + dn;
+    uint64_t* quotient = num + n + 1;
+    const int bits = calClz (d[dn - 1]);
+    if (bits > 0) {
+      CellOps::shl (d, d, dn, bits);
+      num[n] = CellOps::shl (num, src, n, bits);
+    } else {
+      memcpy (num, src, n << 3);
+      num[n] = 0;
+    }
+    Limbs::div (quotient, num, n, d, dn, quotient + n - dn + 1);
+    if (q != nullptr) {
+      memcpy (q, quotient, n - dn + 1 << 3);
+      memset (q + n - dn + 1, 0, dn - 1 << 3);
+    }
+
+    if (bits > 0) {
+      CellOps::shr (num, num, dn, bits);
+    }
+    for (int i = dn - 1; i > -1; --i) {
+      remainder = remainder << CAL_B | num[i];
+    }
+    return remainder;
+  }
+#endif
+
+  const int shift = calClz (value);
+  const uint64_t d = value << shift;
+  if (q == nullptr) {
+    return Limbs::mod1Preinv (src, n, d, shift, calInverse (d));
+  }
+  return Limbs::divRem1Preinv (q, src, n, d, shift, calInverse (d));
+}
+
+void IntegerOps::fastMul (const IntegerView& srcA, const IntegerView& srcB) {
+  mulCells (m_mulResult->m_buf, srcA.m_buf, srcA.m_max, srcB.m_buf, srcB.m_max);
+  m_mulResult->m_sign = srcA.m_sign ^ srcB.m_sign;
+  m_mulResult->setMax (srcA.m_max + srcB.m_max - 1);
+}
+
+/* Offset in an array of count words of size bytes, ordered as given by order
+   and bigEndian, of the byte with significance j (byte 0 being the least
+   significant one).  */
+static inline size_t byteOffset (const size_t j, const size_t count, const int order, const size_t size, const bool bigEndian) {
+  const size_t word = j / size;
+  const size_t byte = j % size;
+  return (order > 0 ? count - 1 - word : word) * size + (bigEndian ? size - 1 - byte : byte);
+}
+
+#if CAL_B % 8 == 0
+/* Returns the cell stored in the CAL_B / 8 bytes at src, most significant
+   byte first if bigEndian is set.  */
+static inline uint64_t loadCell (const unsigned char* src, const bool bigEndian) {
+# if CAL_B == 64
+  uint64_t x;
+  memcpy (&x, src, 8);
+  if (bigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)) {
+    x = __builtin_bswap64 (x);
+  }
+# else
+  uint32_t x;
+  memcpy (&x, src, 4);
+  if (bigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)) {
+    x = __builtin_bswap32 (x);
+  }
+# endif
+  return x;
+}
+
+/* Stores the cell x in the CAL_B / 8 bytes at dst, most significant byte
+   first if bigEndian is set.  */
+static inline void storeCell (unsigned char* dst, const uint64_t x, const bool bigEndian) {
+# if CAL_B == 64
+  uint64_t y = x;
+  if (bigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)) {
+    y = __builtin_bswap64 (y);
+  }
+  memcpy (dst, &y, 8);
+# else
+  uint32_t y = (uint32_t) x;
+  if (bigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)) {
+    y = __builtin_bswap32 (y);
+  }
+  memcpy (dst, &y, 4);
+# endif
+}
+#endif
+
+/* Writes the absolute value of value to dst as the least number of words of
+   size bytes that holds it, i.e. (value.bsr () + 8 size - 1) / (8 size),
+   and returns that number. The words are stored most significant first if
+   order is 1 and least significant first if it is -1; the bytes within a
+   word are most significant first if endian is 1, least significant first
+   if it is -1 and in the machine's order if it is 0 (as mpz_export). If the
+   whole array is in one byte order, cells are moved as a whole with a byte
+   swap where needed.  */
+size_t IntegerOps::exportBytes (void* dst, const IntegerView& value, const int order, const size_t size, const int endian) {
+  VALIDATE_INTEGER ("IntegerOps::exportBytes(void*, const IntegerView&, int, size_t, int)", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (value.m_max > m_size || (order != 1 && order != -1) || size == 0 || endian < -1 || endian > 1) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::exportBytes(void*, const IntegerView&, int, size_t, int)] Argument `value' needs to have at most %d cells, `order' 1 or -1, `size' positive and `endian' 1, 0 or -1.\n", m_size);
+  }
+#endif
+
+  unsigned char* bytes = (unsigned char*) dst;
+  const size_t count = value.m_max > 0 ? (value.bsr () + 8 * size - 1) / (8 * size) : 0;
+  const size_t total = count * size;
+  const bool bigEndian = endian > 0 || endian == 0 && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+  const uint64_t* buf = value.m_buf;
+  size_t j = 0;
+
+#if CAL_B % 8 == 0
+  if (size == 1 || (order > 0) == bigEndian) {
+    const bool reversed = order > 0;
+    const size_t cells = total / (CAL_B / 8) < (size_t) value.m_max ? total / (CAL_B / 8) : value.m_max;
+    for (size_t i = 0; i < cells; ++i, j += CAL_B / 8) {
+      storeCell (reversed ? bytes + total - j - CAL_B / 8 : bytes + j, buf[i], reversed);
+    }
+  }
+#endif
+
+  for (; j < total; ++j) {
+    const size_t pos = 8 * j;
+    const size_t q = CAL_Q (pos);
+    const int r = CAL_R (pos);
+    uint64_t byte = 0;
+    if (q < (size_t) value.m_max) {
+      byte = buf[q] >> r;
+      if (r + 8 > CAL_B && q + 1 < (size_t) value.m_max) {
+        byte |= buf[q + 1] << CAL_B - r;
+      }
+    }
+    bytes[byteOffset (j, count, order, size, bigEndian)] = (unsigned char) byte;
+  }
+  return count;
+}
+
+/* As parse, throwing std::invalid_argument if str cannot be converted.  */
+Integer IntegerOps::fromString (const std::string& str) {
+  Integer result (m_size);
+  if (!parse (str.data (), str.length (), result)) {
+    throw std::invalid_argument ("Not a decimal number or out of range.");
+  }
+  return result;
+}
+
+/* Returns the value of the digit c in a radix of 2^bits, as written by
+   toRadix, or -1 if c is not such a digit.  */
+static inline int radixDigitValue (const char c, const int bits) {
+  int value;
+  if (bits == 6) {
+    if (c >= 'A' && c <= 'Z')
+      value = c - 'A';
+    else if (c >= 'a' && c <= 'z')
+      value = c - 'a' + 26;
+    else if (c >= '0' && c <= '9')
+      value = c - '0' + 52;
+    else if (c == '+')
+      value = 62;
+    else if (c == '/')
+      value = 63;
+    else
+      value = -1;
+  } else {
+    if (c >= '0' && c <= '9')
+      value = c - '0';
+    else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+      value = (c | 0x20) - 'a' + 10;
+    else
+      value = -1;
+    if (value >> bits != 0)
+      value = -1;
+  }
+  return value;
+}
+
+bool IntegerOps::fromHex (const char* str, const size_t length, Integer& dst) {
+  return fromRadix (str, length, 4, dst);
+}
+
+/* Sets dst to the number str[0..length) in a radix of 2^bits, where
+   0 < bits <= 6: an optional '-' followed by one or more digits as written
+   by toRadix (letters in either case if bits <= 5). Returns false, leaving
+   dst unchanged, if str is not such a number or its value does not fit in
+   m_size cells. The digits are packed into cells from the least significant
+   one, in a single pass.  */
+bool IntegerOps::fromRadix (const char* str, const size_t length, const int bits, Integer& dst) {
+  VALIDATE_INTEGER ("IntegerOps::fromRadix(const char*, size_t, int, Integer&)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (dst.m_size != m_size || bits < 1 || bits > 6) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::fromRadix(const char*, size_t, int, Integer&)] Argument `dst' needs to be of size %d and `bits' in the range [1, 6].\n", m_size);
+  }
+#endif
+
+  const char* end = str + length;
+  const bool sign = str < end && *str == '-';
+  if (sign) {
+    ++str;
+  }
+  if (str == end)
+    return false;
+  while (str < end - 1 && radixDigitValue (*str, bits) == 0) {
+    ++str;
+  }
+
+  const int top = radixDigitValue (*str, bits);
+  if (top < 0 || (size_t) (end - str - 1) * bits + 64 - __builtin_clzll (top | 1) > (size_t) m_bsize)
+    return false;
+
+  uint64_t* cells = m_scratch->div ();
+  uint64_t acc = 0;
+  int accBits = 0;
+  int n = 0;
+  for (const char* p = end - 1; p >= str; --p) {
+    const int digit = radixDigitValue (*p, bits);
+    if (digit < 0)
+      return false;
+    acc |= (uint64_t) digit << accBits;
+    accBits += bits;
+    if (accBits >= CAL_B) {
+      cells[n++] = acc & CAL_LMASK[0];
+      accBits -= CAL_B;
+      acc = accBits > 0 ? (uint64_t) digit >> bits - accBits : 0;
+    }
+  }
+  if (accBits > 0) {
+    cells[n++] = acc;
+  }
+  while (n > 0 && cells[n - 1] == 0) {
+    --n;
+  }
+
+  memcpy (dst.m_buf, cells, n << 3);
+  if (n < dst.m_max) {
+    memset (dst.m_buf + n, 0, dst.m_max - n << 3);
+  }
+  dst.m_max = n;
+  dst.m_sign = n > 0 && sign;
+
+  VALIDATE_INTEGER ("IntegerOps::fromRadix(const char*, size_t, int, Integer&)", dst, LOC_AFTER);
+  return true;
+}
+
+/* Sets dst to the non-negative number stored in src as count words of size
+   bytes, with order and endian as in exportBytes. Returns false, leaving
+   dst unchanged, if the number does not fit in m_size cells.  */
+bool IntegerOps::importBytes (Integer& dst, const void* src, const size_t count, const int order, const size_t size, const int endian) {
+  VALIDATE_INTEGER ("IntegerOps::importBytes(Integer&, const void*, size_t, int, size_t, int)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (dst.m_size != m_size || (order != 1 && order != -1) || size == 0 || endian < -1 || endian > 1) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::importBytes(Integer&, const void*, size_t, int, size_t, int)] Argument `dst' needs to be of size %d, `order' 1 or -1, `size' positive and `endian' 1, 0 or -1.\n", m_size);
+  }
+#endif
+
+  const unsigned char* bytes = (const unsigned char*) src;
+  const size_t total = count * size;
+  const bool bigEndian = endian > 0 || endian == 0 && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+  size_t n = total;
+  while (n > 0 && bytes[byteOffset (n - 1, count, order, size, bigEndian)] == 0) {
+    --n;
+  }
+  if (n > 0 && 8 * n - __builtin_clz (bytes[byteOffset (n - 1, count, order, size, bigEndian)]) + 24 > (size_t) m_bsize)
+    return false;
+
+  /* The cells are assembled in scratch, as the last one may be a zero
+     beyond the m_size cells of dst.  */
+  uint64_t* buf = m_scratch->div ();
+  int cells = 0;
+  size_t j = 0;
+
+#if CAL_B % 8 == 0
+  if (size == 1 || (order > 0) == bigEndian) {
+    const bool reversed = order > 0;
+    for (; j + CAL_B / 8 <= n; j += CAL_B / 8) {
+      buf[cells++] = loadCell (reversed ? bytes + total - j - CAL_B / 8 : bytes + j, reversed);
+    }
+  }
+#endif
+
+  uint64_t acc = 0;
+  int accBits = 0;
+  for (; j < n; ++j) {
+    const uint64_t byte = bytes[byteOffset (j, count, order, size, bigEndian)];
+    acc |= byte << accBits;
+    accBits += 8;
+    while (accBits >= CAL_B) {
+      buf[cells++] = acc & CAL_LMASK[0];
+      accBits -= CAL_B;
+      acc = accBits > 0 ? byte >> 8 - accBits : 0;
+    }
+  }
+  if (accBits > 0) {
+    buf[cells++] = acc;
+  }
+
+  while (cells > 0 && buf[cells - 1] == 0) {
+    --cells;
+  }
+  memcpy (dst.m_buf, buf, cells << 3);
+  if (cells < dst.m_max) {
+    memset (dst.m_buf + cells, 0, dst.m_max - cells << 3);
+  }
+  dst.m_max = cells;
+  dst.m_sign = false;
+
+  VALIDATE_INTEGER ("IntegerOps::importBytes(Integer&, const void*, size_t, int, size_t, int)", dst, LOC_AFTER);
+  return true;
+}
+
 bool IntegerOps::inc (Integer& dst) {
   VALIDATE_INTEGER ("IntegerOps::inc(Integer&)", dst, LOC_BEFORE);
 #ifdef DEBUG_MODE
@@ -292,31 +842,503 @@ bool IntegerOps::inc (Integer& dst) {
   return carry;
 }
 
+/* Sets x[0..n] to an approximation X of 2^(2 n CAL_B) / a, where the most
+   significant bit of a[n - 1] is set, such that a X < 2^(2 n CAL_B) <=
+   a (X + 2). The reciprocal X_h of the upper h cells of a is computed
+   recursively and then refined by one Newton step,
+   X = X_h B^l + X_h (B^(n+h) - a X_h) / B^2h, with B = 2^CAL_B (Brent and
+   Zimmermann, Modern Computer Arithmetic, algorithm 3.5).  */
+void IntegerOps::invert (uint64_t* x, const uint64_t* a, const int n, uint64_t* scratch) {
+  if (n < INV_NEWTON_THRESHOLD) {
+    /* floor ((B^2n - 1) / a) - B^n  */
+    uint64_t* t = scratch;
+    for (int i = 0; i < n; ++i) {
+      t[i] = CAL_LMASK[0];
+      t[n + i] = ~a[i] & CAL_LMASK[0];
+    }
+    Limbs::div (x, t, 2 * n - 1, a, n, t + 2 * n);
+    x[n] = 1;
+    return;
+  }
+
+  const int l = n - 1 >> 1;
+  const int h = n - l;
+  uint64_t* xh = x + l;
+  invert (xh, a + l, h, scratch);
+
+  uint64_t* t = scratch;
+  uint64_t* u = t + n + h + 1;
+  mulCells (t, a, n, xh, h + 1);
+  while (t[n + h] != 0) {
+    CellOps::sub (xh, xh, h + 1, &one, 1);
+    CellOps::sub (t, t, n + h + 1, a, n);
+  }
+  for (int i = 0; i < n + h; ++i) {
+    t[i] = ~t[i] & CAL_LMASK[0];
+  }
+  CellOps::add (t, t, n + h, &one, 1);
+
+  int tn = 2 * h;
+  while (tn > 1 && t[l + tn - 1] == 0) {
+    --tn;
+  }
+  mulCells (u, t + l, tn, xh, h + 1);
+  const int un = tn + h + 1 - (2 * h - l);
+  memset (x, 0, l << 3);
+  if (un > 0) {
+    CellOps::add (x, x, n + 1, u + 2 * h - l, un < n + 1 ? un : n + 1);
+  }
+}
+
+/* Returns the absolute value of the remainder of src divided by value.  */
+uint64_t IntegerOps::mod (const IntegerView& src, const uint64_t value) {
+  VALIDATE_INTEGER ("IntegerOps::mod(const IntegerView&, uint64_t)", src, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (src.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mod(const IntegerView&, uint64_t)] Argument `src' needs to have at most %d cells.\n", m_size);
+  }
+#endif
+
+  if (value == 0) {
+    throw std::runtime_error ("Division by zero.");
+  }
+
+  return src.m_max > 0 ? divRemWord (nullptr, src.m_buf, src.m_max, value) : 0;
+}
+
 /* Modifies: m_mulResult.  */
-Integer& IntegerOps::mul (const Integer& srcA, const Integer& srcB) {
-  VALIDATE_INTEGER ("IntegerOps::mul(const Integer&, const Integer&)", srcA, LOC_BEFORE);
-  VALIDATE_INTEGER ("IntegerOps::mul(const Integer&, const Integer&)", srcB, LOC_BEFORE);
+Integer& IntegerOps::mul (const IntegerView& srcA, const IntegerView& srcB) {
+  VALIDATE_INTEGER ("IntegerOps::mul(const IntegerView&, const IntegerView&)", srcA, LOC_BEFORE);
+  VALIDATE_INTEGER ("IntegerOps::mul(const IntegerView&, const IntegerView&)", srcB, LOC_BEFORE);
 #ifdef DEBUG_MODE
-  if (!(srcA.m_size == m_size && srcB.m_size == m_size)) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mul(const Integer&, const Integer&)] The two arguments `srcA' and `srcB' need to be of size %d.\n", m_size);
+  if (!(srcA.m_max <= m_size && srcB.m_max <= m_size)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mul(const IntegerView&, const IntegerView&)] The two arguments `srcA' and `srcB' need to have at most %d cells.\n", m_size);
+  }
+  if (srcA.m_buf == m_mulResult->m_buf || srcB.m_buf == m_mulResult->m_buf) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mul(const IntegerView&, const IntegerView&)] The arguments `srcA' and `srcB' cannot be the result of a previous multiplication.\n");
   }
 #endif
 
+  if (srcA.m_buf == srcB.m_buf && srcA.m_max == srcB.m_max && srcA.m_sign == srcB.m_sign) {
+    return sqr (srcA);
+  }
+
   *m_mulResult = 0;
-  if (srcA.m_max > 0 && srcB.m_max > 0) {
+  if (srcA.m_max >= KARATSUBA_THRESHOLD && srcB.m_max >= KARATSUBA_THRESHOLD) {
+    fastMul (srcA, srcB);
+  } else if (srcA.m_max > 0 && srcB.m_max > 0) {
     baseMul (srcA, srcB);
   }
 
-  VALIDATE_INTEGER ("IntegerOps::mul(const Integer&, const Integer&)", *m_mulResult, LOC_AFTER);
+  VALIDATE_INTEGER ("IntegerOps::mul(const IntegerView&, const IntegerView&)", *m_mulResult, LOC_AFTER);
   return *m_mulResult;
 }
 
-bool IntegerOps::sub (Integer& dst, const Integer& src) {
-  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const Integer&)", dst, LOC_BEFORE);
-  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const Integer&)", src, LOC_BEFORE);
+/* Stores the product of the values of srcA and srcB with the same index in
+   dst, whose values need to be of size 2 * m_size.  */
+void IntegerOps::mul (IntegerBatch& dst, const IntegerBatch& srcA, const IntegerBatch& srcB) {
 #ifdef DEBUG_MODE
-  if (!(dst.m_size == m_size && src.m_size == m_size)) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::sub(Integer&, const Integer&)] The two arguments `dst' and `src' need to be of size %d.\n", m_size);
+  if (!(dst.m_size == 2 * m_size && srcA.m_size == m_size && srcB.m_size == m_size && dst.m_count == srcA.m_count && dst.m_count == srcB.m_count)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mul(IntegerBatch&, const IntegerBatch&, const IntegerBatch&)] Arguments `srcA' and `srcB' need to hold values of size %d, and `dst' as many of size %d.\n", m_size, 2 * m_size);
+  }
+#endif
+
+  Batch::mul (dst.m_cells, dst.m_signs, dst.m_stride, srcA.m_cells, srcA.m_signs, srcB.m_cells, srcB.m_signs, m_size, srcA.m_stride);
+}
+
+/* dst[0..an+bn) = a * b for any an, bn > 0, using number-theoretic transforms
+   for large operands.  */
+void IntegerOps::mulCells (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+  if (an < bn) {
+    mulCells (dst, b, bn, a, an);
+    return;
+  }
+#ifdef __SIZEOF_INT128__
+  if (bn >= NTT_THRESHOLD) {
+    Ntt& transforms = m_scratch->ntt ();
+    const bool parallel = m_threads > 1 && bn >= NTT_PARALLEL_THRESHOLD;
+    if (an + bn > transforms.maxLength ()) {
+      /* The products of a reciprocal have a cell more than the 2 m_size the
+         transforms are set up for; the top cell of a is multiplied in apart.  */
+      transforms.mul (dst, a, an - 1, b, bn, parallel);
+      dst[an + bn - 1] = CellOps::addMul1 (dst + an - 1, b, bn, a[an - 1]);
+    } else {
+      transforms.mul (dst, a, an, b, bn, parallel);
+    }
+  } else {
+    Limbs::mul (dst, a, an, b, bn, m_scratch->mul ());
+  }
+#else
+  Limbs::mul (dst, a, an, b, bn, m_scratch->mul ());
+#endif
+}
+
+/* Multiplies dst by value; returns true if the product does not fit, in which
+   case dst holds its lower m_size cells.  */
+bool IntegerOps::mulWord (Integer& dst, const uint64_t value) {
+  VALIDATE_INTEGER ("IntegerOps::mulWord(Integer&, uint64_t)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (dst.m_size != m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::mulWord(Integer&, uint64_t)] Argument `dst' needs to be of size %d.\n", m_size);
+  }
+#endif
+
+  bool carry = false;
+  if (value == 0) {
+    dst = 0;
+  } else if (dst.m_max > 0) {
+
+#if CAL_B < 64
+    if (value > CAL_LMASK[0]) {
+      uint64_t* w = m_scratch->div ();
+      const int wn = wordToCells (w, value);
+      uint64_t* product = w + wn;
+      int pn = dst.m_max + wn;
+      Limbs::mulBasecase (product, dst.m_buf, dst.m_max, w, wn);
+      for (int i = m_size; i < pn; ++i) {
+        carry |= product[i] != 0;
+      }
+      if (pn > m_size)
+        pn = m_size;
+      memcpy (dst.m_buf, product, pn << 3);
+      dst.setMax (pn - 1);
+    } else {
+#endif
+
+      const uint64_t high = CellOps::mul1 (dst.m_buf, dst.m_buf, dst.m_max, value);
+      if (high != 0 && dst.m_max < m_size) {
+        dst.m_buf[dst.m_max++] = high;
+      } else {
+        carry = high != 0;
+        dst.setMax (dst.m_max - 1);
+      }
+
+#if CAL_B < 64
+    }
+#endif
+
+    dst.m_sign = dst.m_max > 0 && dst.m_sign;
+  }
+
+  VALIDATE_INTEGER ("IntegerOps::mulWord(Integer&, uint64_t)", dst, LOC_AFTER);
+  return carry;
+}
+
+/* Divides |dst| by the denominator of n >= 2 cells, where dst.m_max >= n,
+   storing the quotient in dst and the remainder in m_remainder, which is zero
+   on entry.  */
+void IntegerOps::newtonDiv (Integer& dst, const Reciprocal& denominator) {
+  const int n = denominator.m_size;
+  const int nn = dst.m_max;
+  const int qn = nn - n + 1;
+  uint64_t* num = m_scratch->newton ();
+  uint64_t* q = num + nn + 1;
+
+  if (denominator.m_shift > 0) {
+    num[nn] = CellOps::shl (num, dst.m_buf, nn, denominator.m_shift);
+  } else {
+    memcpy (num, dst.m_buf, nn << 3);
+    num[nn] = 0;
+  }
+
+  newtonDiv (q, num, nn, denominator, q + qn);
+
+  memset (dst.m_buf, 0, nn << 3);
+  memcpy (dst.m_buf, q, qn << 3);
+  dst.setMax (qn - 1);
+
+  if (denominator.m_shift > 0) {
+    CellOps::shr (m_remainder->m_buf, num, n, denominator.m_shift);
+  } else {
+    memcpy (m_remainder->m_buf, num, n << 3);
+  }
+  m_remainder->setMax (n - 1);
+}
+
+/* As Limbs::div for the normalised denominator of n >= 2 cells held by the
+   reciprocal; scratch must hold at least 2n + 1 + Limbs::divScratchSize (n)
+   cells. The quotient is computed in blocks of n cells from the top, each
+   estimated from the upper n cells of the partial remainder times the
+   reciprocal and at most two too small. A top block of fewer cells is left to
+   Limbs::div.  */
+void IntegerOps::newtonDiv (uint64_t* q, uint64_t* num, const int nn, const Reciprocal& denominator, uint64_t* scratch) {
+  const int n = denominator.m_size;
+  const int qn = nn - n + 1;
+  const int k = qn % n;
+  const uint64_t* a = denominator.m_buf;
+  const uint64_t* x = a + n;
+  uint64_t* p = scratch;
+
+  if (k > 0) {
+    memset (q + qn - k, 0, k << 3);
+    Limbs::div (q + qn - k, num + qn - k, n + k - 1, a, n, p);
+  }
+  for (int pos = qn - k - n; pos > -1; pos -= n) {
+    uint64_t* w = num + pos;
+    uint64_t* qhat = q + pos;
+    mulCells (p, x, n + 1, w + n, n);
+    memcpy (qhat, p + n, n << 3);
+    mulCells (p, a, n, qhat, n);
+    CellOps::sub (w, w, 2 * n, p, 2 * n);
+    while (!lessThan (w, n + 1, a, n)) {
+      CellOps::sub (w, w, n + 1, a, n);
+      CellOps::add (qhat, qhat, n, &one, 1);
+    }
+  }
+}
+
+/* Returns true if the 8 characters at str are all digits, storing their value
+   in value. The characters are checked and combined 8 at a time within a 64
+   bit word, first into 4 values of 2 digits, then 2 of 4 digits.  */
+static inline bool parse8Digits (const char* str, uint64_t& value) {
+  uint64_t x;
+  memcpy (&x, str, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  x = __builtin_bswap64 (x);
+#endif
+  if ((x & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030 || (x + 0x0606060606060606 & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030)
+    return false;
+  x -= 0x3030303030303030;
+  x = x * 10 + (x >> 8) & 0x00FF00FF00FF00FF;
+  x = x * 100 + (x >> 16) & 0x0000FFFF0000FFFF;
+  value = x * 10000 + (x >> 32) & 0xFFFFFFFF;
+  return true;
+}
+
+/* Returns true if the length <= 18 characters at str are all digits, storing
+   their value in value.  */
+static bool parseChunk (const char* str, int length, uint64_t& value) {
+  uint64_t result = 0;
+  for (; length >= 8; str += 8, length -= 8) {
+    uint64_t part;
+    if (!parse8Digits (str, part))
+      return false;
+    result = result * 100000000 + part;
+  }
+  for (; length > 0; ++str, --length) {
+    const unsigned int digit = (unsigned char) *str - '0';
+    if (digit > 9)
+      return false;
+    result = result * 10 + digit;
+  }
+  value = result;
+  return true;
+}
+
+/* Maximum number of cells of a value of m chunks of 18 digits, each of which
+   is less than 2^60.  */
+static inline int chunkCells (const int m) {
+  return (60 * m + CAL_B - 1) / CAL_B + 1;
+}
+
+/* Sets dst to the value of the decimal number str[0..length), an optional
+   sign followed by one or more digits. Returns false, leaving dst unchanged,
+   if str is not such a number or its value does not fit in m_size cells; no
+   exceptions are thrown.  */
+bool IntegerOps::parse (const char* str, const size_t length, Integer& dst) {
+  VALIDATE_INTEGER ("IntegerOps::parse(const char*, size_t, Integer&)", dst, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (dst.m_size != m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::parse(const char*, size_t, Integer&)] Argument `dst' needs to be of size %d.\n", m_size);
+  }
+#endif
+
+  const char* end = str + length;
+  bool sign = false;
+  if (str < end && (*str == '-' || *str == '+')) {
+    sign = *str == '-';
+    ++str;
+  }
+  if (str == end)
+    return false;
+  while (str < end - 1 && *str == '0') {
+    ++str;
+  }
+
+  /* value < 10^digits, which fits in m_size + 1 cells.  */
+  const size_t digits = end - str;
+  if (digits > (size_t) (0.30103 * m_bsize) + 1)
+    return false;
+
+  /* The chunks are stored least significant first; the most significant one
+     has between 1 and 18 digits.  */
+  const int m = (int) ((digits + 17) / 18);
+  int k = 0;
+  if (m >= PARSE_DC_THRESHOLD) {
+    while (2 << k < m) {
+      ++k;
+    }
+    if (decimalPowers (k) < k)
+      return false;
+  }
+
+  /* The powers are created first, as createReciprocal uses the same
+     scratch.  */
+  uint64_t* chunks = m_scratch->newton ();
+  uint64_t* cells = chunks + m;
+  const int topLength = (int) (digits - 18 * (m - 1));
+  if (!parseChunk (str, topLength, chunks[m - 1]))
+    return false;
+  for (int i = m - 2; i > -1; --i) {
+    if (!parseChunk (end - 18 * (i + 1), 18, chunks[i]))
+      return false;
+  }
+
+  const int n = parseChunks (cells, chunks, m, cells + chunkCells (m));
+  if (n > m_size)
+    return false;
+
+  memcpy (dst.m_buf, cells, n << 3);
+  if (n < dst.m_max) {
+    memset (dst.m_buf + n, 0, dst.m_max - n << 3);
+  }
+  dst.m_max = n;
+  dst.m_sign = n > 0 && sign;
+
+  VALIDATE_INTEGER ("IntegerOps::parse(const char*, size_t, Integer&)", dst, LOC_AFTER);
+  return true;
+}
+
+/* Stores the value of the m chunks of 18 digits in dst, which must hold
+   chunkCells (m) cells, and returns the number of cells used. Long values are
+   split at 10^(18 h), with h the largest power of 2 less than m, and the
+   upper part is multiplied by the cached power.  */
+int IntegerOps::parseChunks (uint64_t* dst, const uint64_t* chunks, const int m, uint64_t* scratch) {
+  int n = 0;
+  if (m < PARSE_DC_THRESHOLD) {
+
+#if CAL_B < 64
+    uint64_t exa[wordCells];
+    uint64_t chunk[wordCells];
+    const int en = wordToCells (exa, 1000000000000000000);
+    for (int i = m - 1; i > -1; --i) {
+      if (n > 0) {
+        Limbs::mulBasecase (scratch, dst, n, exa, en);
+        n += en;
+        memcpy (dst, scratch, n << 3);
+      }
+      const int cn = wordToCells (chunk, chunks[i]);
+      while (n < cn) {
+        dst[n++] = 0;
+      }
+      if (cn > 0 && CellOps::add (dst, dst, n, chunk, cn)) {
+        dst[n++] = 1;
+      }
+      while (n > 0 && dst[n - 1] == 0) {
+        --n;
+      }
+    }
+#else
+    for (int i = m - 1; i > -1; --i) {
+      uint64_t high = chunks[i];
+      for (int j = 0; j < n; ++j) {
+        dst[j] = calMulAdd (dst[j], 1000000000000000000, 0, high);
+      }
+      if (high != 0) {
+        dst[n++] = high;
+      }
+    }
+#endif
+
+    return n;
+  }
+
+  int k = 0;
+  while (2 << k < m) {
+    ++k;
+  }
+  const int h = 1 << k;
+  uint64_t* low = scratch;
+  uint64_t* high = low + chunkCells (h);
+  uint64_t* rest = high + chunkCells (m - h);
+  const int ln = parseChunks (low, chunks, h, rest);
+  const int hn = parseChunks (high, chunks + h, m - h, rest);
+  if (hn == 0) {
+    memcpy (dst, low, ln << 3);
+    return ln;
+  }
+
+  const Reciprocal& power = *m_decimalPowers[k];
+  n = hn + power.m_size;
+  mulCells (dst, high, hn, power.m_buf, power.m_size);
+  if (power.m_shift > 0) {
+    CellOps::shr (dst, dst, n, power.m_shift);
+  }
+  if (ln > 0) {
+    CellOps::add (dst, dst, n, low, ln);
+  }
+  while (dst[n - 1] == 0) {
+    --n;
+  }
+  return n;
+}
+
+/* Returns the number of characters written by toRadix.  */
+size_t IntegerOps::radixLength (const IntegerView& value, const int bits) {
+  const size_t digits = value.m_max > 0 ? (value.bsr () + bits - 1) / bits : 1;
+  return digits + value.m_sign;
+}
+
+/* With enabled set, products and squares of operands from
+   IFMA_MUL_THRESHOLD and IFMA_SQR_THRESHOLD cells up to the Karatsuba
+   thresholds are computed with the AVX-512 IFMA instructions, if the
+   processor has them and CAL_B is 64; this is the default. Returns whether
+   they are used. Affects all IntegerOps.  */
+bool IntegerOps::setIfma (const bool enabled) {
+  return Ifma::setActive (enabled);
+}
+
+/* With threads > 1, the transforms of products of at least
+   NTT_PARALLEL_THRESHOLD cells are spread over this thread and the workers
+   of a pool shared by all IntegerOps, which is given at least threads - 1
+   workers. 1, the default, keeps all work in this thread.  */
+void IntegerOps::setThreads (const int threads) {
+  m_threads = threads;
+  if (threads > 1) {
+    TaskPool::instance ().reserve (threads - 1);
+  }
+}
+
+Integer& IntegerOps::sqr (const IntegerView& src) {
+  VALIDATE_INTEGER ("IntegerOps::sqr(const IntegerView&)", src, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (src.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::sqr(const IntegerView&)] Argument `src' needs to have at most %d cells.\n", m_size);
+  }
+  if (src.m_buf == m_mulResult->m_buf) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::sqr(const IntegerView&)] Argument `src' cannot be the result of a previous multiplication.\n");
+  }
+#endif
+
+  *m_mulResult = 0;
+  if (src.m_max > 0) {
+    sqrCells (m_mulResult->m_buf, src.m_buf, src.m_max);
+    m_mulResult->setMax (2 * src.m_max - 1);
+  }
+
+  VALIDATE_INTEGER ("IntegerOps::sqr(const IntegerView&)", *m_mulResult, LOC_AFTER);
+  return *m_mulResult;
+}
+
+/* dst[0..2n) = a[0..n) squared, where n > 0.  */
+void IntegerOps::sqrCells (uint64_t* dst, const uint64_t* a, const int n) {
+#ifdef __SIZEOF_INT128__
+  if (n >= NTT_THRESHOLD) {
+    m_scratch->ntt ().sqr (dst, a, n, m_threads > 1 && n >= NTT_PARALLEL_THRESHOLD);
+  } else {
+    Limbs::sqr (dst, a, n, m_scratch->mul ());
+  }
+#else
+  Limbs::sqr (dst, a, n, m_scratch->mul ());
+#endif
+}
+
+bool IntegerOps::sub (Integer& dst, const IntegerView& src) {
+  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const IntegerView&)", dst, LOC_BEFORE);
+  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const IntegerView&)", src, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (!(dst.m_size == m_size && src.m_max <= m_size)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::sub(Integer&, const IntegerView&)] Argument `dst' needs to be of size %d and `src' to have at most as many cells.\n", m_size);
   }
 #endif
 
@@ -336,143 +1358,358 @@ bool IntegerOps::sub (Integer& dst, const Integer& src) {
     carry = false;
   }
 
-  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const Integer&)", dst, LOC_AFTER);
+  VALIDATE_INTEGER ("IntegerOps::sub(Integer&, const IntegerView&)", dst, LOC_AFTER);
   return carry;
 }
 
-bool IntegerOps::subtractFromRemainder (const Integer& denominator, int denomBsr, int remainderBsr) {
+/* As add, subtracting.  */
+bool IntegerOps::sub (IntegerBatch& dst, const IntegerBatch& src) {
 #ifdef DEBUG_MODE
-  if (denominator.bsr () != denomBsr) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::subtractFromRemainder(const Integer&, int, int)] denominator.bsr () != denomBsr.\n");
-  }
-  if (m_remainder->bsr () != remainderBsr) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::subtractFromRemainder(const Integer&, int, int)] m_remainder->bsr () != remainderBsr.\n");
+  if (!(dst.m_size == m_size && src.m_size == m_size && dst.m_count == src.m_count)) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::sub(IntegerBatch&, const IntegerBatch&)] Arguments `dst' and `src' need to hold as many values, of size %d.\n", m_size);
   }
-  if (!(remainderBsr == denomBsr || remainderBsr == denomBsr + 1)) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::subtractFromRemainder(const Integer&, int, int)] !(remainderBsr == denomBsr || remainderBsr == denomBsr + 1).\n");
+#endif
+
+  return Batch::add (dst.m_cells, dst.m_signs, dst.m_cells, dst.m_signs, src.m_cells, src.m_signs, m_size, dst.m_stride, true);
+}
+
+/* Writes the 32 bits of value as 8 hex digits to dst. The nibbles are spread
+   over the bytes of a 64 bit word and converted to ASCII together: '0' is
+   added to each, and 'a' - '0' - 10 more to those of 10 and above.  */
+static inline void hexDigits (char* dst, const uint64_t value) {
+  uint64_t x = value & 0xFFFFFFFF;
+  x = (x | x << 16) & 0x0000FFFF0000FFFF;
+  x = (x | x << 8) & 0x00FF00FF00FF00FF;
+  x = (x | x << 4) & 0x0F0F0F0F0F0F0F0F;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  x = __builtin_bswap64 (x);
+#endif
+  x += 0x3030303030303030 + ((x + 0x0606060606060606 >> 4 & 0x0101010101010101) * 0x27);
+  memcpy (dst, &x, 8);
+}
+
+static const char radixDigits[] = "0123456789abcdefghijklmnopqrstuv";
+static const char base64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string IntegerOps::toHex (const IntegerView& value) {
+  std::string result (radixLength (value, 4), '\0');
+  toRadix (&result[0], value, 4);
+  return result;
+}
+
+/* Writes value in a radix of 2^bits, where 0 < bits <= 6, to dst and returns
+   the number of characters written, which is radixLength (value, bits). The
+   digits are 0-9 followed by lower case letters, or for bits = 6 those of
+   base64 (A-Z, a-z, 0-9, + and /); a negative value is preceded by '-'. No
+   terminating null character is written.  */
+size_t IntegerOps::toRadix (char* dst, const IntegerView& value, const int bits) {
+  VALIDATE_INTEGER ("IntegerOps::toRadix(char*, const IntegerView&, int)", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (value.m_max > m_size || bits < 1 || bits > 6) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::toRadix(char*, const IntegerView&, int)] Argument `value' needs to have at most %d cells and `bits' in the range [1, 6].\n", m_size);
   }
 #endif
 
-  int i;
-  bool carry = false;
-  if (remainderBsr == denomBsr) {
+  const char* digitChars = bits == 6 ? base64Digits : radixDigits;
+  const size_t length = radixLength (value, bits);
+  char* p = dst;
+  if (value.m_sign) {
+    *p++ = '-';
+  }
+  if (value.m_max == 0) {
+    *p = digitChars[0];
+    return length;
+  }
 
-    for (i = 0; i < denominator.m_max; ++i) {
-      m_aux->m_buf[i] = m_remainder->m_buf[i];
-      if (carry) {
-        CAL_CLEAR_CARRY (m_remainder->m_buf[i - 1]);
-        --m_remainder->m_buf[i];
-      }
-      m_remainder->m_buf[i] -= denominator.m_buf[i];
-      carry = CAL_CARRY (m_remainder->m_buf[i]);
-    }
-    if (m_aux->m_max < denominator.m_max)
-      m_aux->m_max = denominator.m_max;
-    if (carry) {
-      memcpy (m_remainder->m_buf, m_aux->m_buf, denominator.m_max << 3);
-    } else {
-      m_remainder->setMax (i - 1);
+  const uint64_t* buf = value.m_buf;
+  const uint64_t mask = (1 << bits) - 1;
+  size_t i = dst + length - p;
+
+#if CAL_B % 32 == 0
+  /* Cells below the most significant one hold whole hex digits, which are
+     written 8 at a time.  */
+  const size_t cellDigits = CAL_B / 4;
+  const size_t bulk = bits == 4 ? (value.m_max - 1) * cellDigits : 0;
+#else
+  const size_t bulk = 0;
+#endif
+
+  while (i > bulk) {
+    --i;
+    const size_t pos = i * bits;
+    const int q = CAL_Q (pos);
+    const int r = CAL_R (pos);
+    uint64_t digit = buf[q] >> r;
+    if (r + bits > CAL_B && q + 1 < value.m_max) {
+      digit |= buf[q + 1] << CAL_B - r;
     }
+    *p++ = digitChars[digit & mask];
+  }
 
-  } else {
+#if CAL_B % 32 == 0
+  for (int j = (int) (bulk / cellDigits) - 1; j > -1; --j) {
+# if CAL_B == 64
+    hexDigits (p, buf[j] >> 32);
+    p += 8;
+# endif
+    hexDigits (p, buf[j]);
+    p += 8;
+  }
+#endif
+
+  return length;
+}
+
+/* Destination of the characters produced by toChars: a buffer which, when
+   writing to a stream, is passed on to it whenever it fills up.  */
+class IntegerOps::DigitOutput {
+private:
+  char* m_begin;
+  char* m_pos;
+  char* m_end;
+  FILE* m_file;
+  std::ostream* m_stream;
+  bool m_error;
+
+public:
+  /* Writes to [begin, end), which must have room for all characters.  */
+  DigitOutput (char* begin, char* end) : m_begin (begin), m_pos (begin), m_end (end), m_file (nullptr), m_stream (nullptr), m_error (false) {
+  }
+
+  /* Writes to file or stream, using [begin, end) as buffer, which must have
+     room for at least 18 characters.  */
+  DigitOutput (char* begin, char* end, FILE* file, std::ostream* stream) : m_begin (begin), m_pos (begin), m_end (end), m_file (file), m_stream (stream), m_error (false) {
+  }
 
-    for (i = 0; i < denominator.m_max; ++i) {
-      if (carry) {
-        CAL_CLEAR_CARRY (m_remainder->m_buf[i - 1]);
-        --m_remainder->m_buf[i];
+  /* Returns a pointer to count (at most 18) characters to be written.  */
+  char* claim (const int count) {
+    if (m_pos + count > m_end) {
+      flush ();
+    }
+    char* result = m_pos;
+    m_pos += count;
+    return result;
+  }
+
+  void fill (size_t count) {
+    while (count > 0) {
+      if (m_pos == m_end) {
+        flush ();
       }
-      m_remainder->m_buf[i] -= denominator.m_buf[i];
-      carry = CAL_CARRY (m_remainder->m_buf[i]);
+      const size_t n = count < (size_t) (m_end - m_pos) ? count : m_end - m_pos;
+      memset (m_pos, '0', n);
+      m_pos += n;
+      count -= n;
     }
-    if (carry) {
-      CAL_CLEAR_CARRY (m_remainder->m_buf[i - 1]);
-      m_remainder->m_buf[i] = 0;
-      carry = false;
+  }
+
+  /* Passes the buffered characters on; returns false if this, or an earlier
+     flush, failed.  */
+  bool flush (void) {
+    const size_t n = m_pos - m_begin;
+    if (m_file != nullptr) {
+      m_error |= fwrite (m_begin, 1, n, m_file) != n;
+    } else if (m_stream != nullptr) {
+      m_error |= !m_stream->write (m_begin, n);
     }
-    m_remainder->setMax (i - 1);
+    m_pos = m_begin;
+    return !m_error;
+  }
+};
+
+/* Writes the 8 decimal digits of val < 10^8 to dst. The two halves of 4
+   digits are put in the two 32 bit lanes of a word, each lane is split in
+   two lanes of 2 digits and those in two of 1 digit, dividing by 100 and 10
+   in all lanes at once with a multiplication and a shift.  */
+static inline void octetChars (char* dst, const uint64_t val) {
+  uint64_t x = val / 10000 | val % 10000 << 32;
+  uint64_t q = (x * 10486 >> 20) & 0x0000007F0000007F;
+  x = q | x - q * 100 << 16;
+  q = (x * 103 >> 10) & 0x000F000F000F000F;
+  x = q | x - q * 10 << 8;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  x = __builtin_bswap64 (x);
+#endif
+  x += 0x3030303030303030;
+  memcpy (dst, &x, 8);
+}
 
+/* Writes the 18 decimal digits of val < 10^18 to dst.  */
+static void blockChars (char* dst, const uint64_t val) {
+  const uint64_t low = val % 100000000;
+  const uint64_t high = val / 100000000;
+  const uint32_t top = (uint32_t) (high / 100000000);
+  dst[0] = top / 10 + '0';
+  dst[1] = top % 10 + '0';
+  octetChars (dst + 2, high % 100000000);
+  octetChars (dst + 10, low);
+}
+
+/* Writes the decimal representation of value to dst.  */
+void IntegerOps::toChars (DigitOutput& dst, const IntegerView& value) {
+  if (value.m_sign) {
+    *dst.claim (1) = '-';
+  }
+  if (value.m_max == 0) {
+    *dst.claim (1) = '0';
+    return;
   }
 
-  VALIDATE_INTEGER ("IntegerOps::subtractFromRemainder(const Integer&, int, int)", *m_remainder, LOC_AFTER);
-  VALIDATE_INTEGER ("IntegerOps::subtractFromRemainder(const Integer&, int, int)", *m_aux, LOC_AFTER);
-  return !carry;
+  /* value < 10^(18 2^(k+1)), also if a power turns out not to fit.  */
+  const int digitsNeeded = (int) (0.30103 * value.bsr ()) + 1;
+  int k = -1;
+  while (18 << k + 1 < digitsNeeded) {
+    ++k;
+  }
+  if (k > 0 && value.m_max >= TOSTRING_DC_THRESHOLD) {
+    k = decimalPowers (k);
+  }
+
+  /* The powers are created first, as createReciprocal uses the same
+     scratch.  */
+  uint64_t* x = m_scratch->newton ();
+  memcpy (x, value.m_buf, value.m_max << 3);
+  toChars (dst, x, value.m_max, k, false, x + value.m_max);
 }
 
-static void appendChars (std::string& str, int64_t val, bool withLeadingZeros) {
-  int i;
-  char buf[18];
+/* Writes the decimal representation of x[0..n), where x < 10^(18 2^(k+1)),
+   to dst; with exactly 18 2^(k+1) digits if pad is set. x is split by the
+   cached power 10^(18 2^k) and both halves are converted recursively; small
+   numbers are split into blocks of 18 digits with divRemWord, destroying x.
+   scratch must hold about 3n + 2 Limbs::divScratchSize (n) cells.  */
+void IntegerOps::toChars (DigitOutput& dst, uint64_t* x, int n, const int k, const bool pad, uint64_t* scratch) {
+  while (n > 0 && x[n - 1] == 0) {
+    --n;
+  }
 
-  if (withLeadingZeros) {
-    for (i = 0; i < 18; ++i) {
-      buf[i] = val % 10 + '0';
-      val /= 10;
+  if (k < 1 || n < TOSTRING_DC_THRESHOLD) {
+    uint64_t parts[TOSTRING_DC_THRESHOLD * CAL_B / 59 + 2];
+    int i = 0;
+    while (n > 0) {
+      parts[i++] = divRemWord (x, x, n, 1000000000000000000);
+      while (n > 0 && x[n - 1] == 0) {
+        --n;
+      }
     }
-  } else {
-    i = 0;
-    while (val != 0) {
-      buf[i++] = val % 10 + '0';
-      val /= 10;
+    if (pad) {
+      dst.fill (18 * ((1 << k + 1) - i));
+    } else if (i > 0) {
+      char top[18];
+      blockChars (top, parts[--i]);
+      int j = 0;
+      while (top[j] == '0') {
+        ++j;
+      }
+      memcpy (dst.claim (18 - j), top + j, 18 - j);
+    }
+    while (i > 0) {
+      blockChars (dst.claim (18), parts[--i]);
     }
+    return;
   }
-  --i;
-  while (i > -1) {
-    str += buf[i];
-    --i;
+
+  const Reciprocal& power = *m_decimalPowers[k];
+  const int pn = power.m_size;
+  if (n < pn) {
+    if (pad) {
+      dst.fill (18 << k);
+    }
+    toChars (dst, x, n, k - 1, pad, scratch);
+    return;
   }
-}
 
-int IntegerOps::splitUp (int64_t* parts, Integer& value) {
-  int index = 0;
-  Integer exa = createInteger (1000000000000000000);
-  while (value.m_max > 0) {
-    Integer& remainder = div (value, exa);
-    parts[index++] = (int64_t) remainder;
+  const int qn = n - pn + 1;
+  uint64_t* num = scratch;
+  uint64_t* q = num + n + 1;
+  if (power.m_shift > 0) {
+    num[n] = CellOps::shl (num, x, n, power.m_shift);
+  } else {
+    memcpy (num, x, n << 3);
+    num[n] = 0;
+  }
+  if (pn >= DIV_NEWTON_THRESHOLD) {
+    newtonDiv (q, num, n, power, q + qn);
+  } else {
+    Limbs::div (q, num, n, power.m_buf, pn, q + qn);
+  }
+  if (power.m_shift > 0) {
+    CellOps::shr (num, num, pn, power.m_shift);
   }
-  return index - 1;
-}
 
-void IntegerOps::toString (std::string& dst, int64_t* parts, Integer& value) {
-  int i = splitUp (parts, value);
-  appendChars (dst, parts[i--], false);
-  while (i > -1) {
-    appendChars (dst, parts[i--], true);
+  int top = qn;
+  while (top > 0 && q[top - 1] == 0) {
+    --top;
+  }
+  if (pad || top > 0) {
+    toChars (dst, q, qn, k - 1, pad, q + qn);
+    toChars (dst, num, pn, k - 1, true, q + qn);
+  } else {
+    toChars (dst, num, pn, k - 1, false, q + qn);
   }
 }
 
-/* Modifies: m_aux, m_remainder, m_numerator.  */
-std::string IntegerOps::toString (const Integer& value) {
-  VALIDATE_INTEGER ("IntegerOps::toString(const Integer&)", value, LOC_BEFORE);
+/* Writes the decimal representation of value to [first, last) if it fits,
+   and returns its length; if it does not fit, nothing is written, so that
+   toChars (nullptr, nullptr, value) returns the number of characters to
+   provide. No terminating null character is written.  */
+size_t IntegerOps::toChars (char* first, char* last, const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerOps::toChars(char*, char*, const IntegerView&)", value, LOC_BEFORE);
 #ifdef DEBUG_MODE
-  if (value.m_size != m_size) {
-    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::toString(const Integer&)] Argument `value' needs to be of size %d.\n", m_size);
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::toChars(char*, char*, const IntegerView&)] Argument `value' needs to have at most %d cells.\n", m_size);
   }
 #endif
 
-  std::string result;
-  if (value.m_max == 0) {
-    result = "0";
-    return result;
+  const size_t length = decimalLength (value);
+  if ((size_t) (last - first) >= length) {
+    DigitOutput dst (first, last);
+    toChars (dst, value);
   }
+  return length;
+}
 
-  /* Estimate number of digits needed.  */
-  const int digitsNeeded = (int) (0.30103 * value.bsr ()) + 1;
-  const int eighteenDigitBlocks = digitsNeeded / 18 + 1;
-  if (digitsNeeded > 14)
-    result.reserve (digitsNeeded + 1);
+std::string IntegerOps::toString (const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerOps::toString(const IntegerView&)", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::toString(const IntegerView&)] Argument `value' needs to have at most %d cells.\n", m_size);
+  }
+#endif
+
+  std::string result (decimalLength (value), '\0');
+  DigitOutput dst (&result[0], &result[0] + result.length ());
+  toChars (dst, value);
+  return result;
+}
 
-  Integer temp = value;
-  if (temp.m_sign) {
-    temp.m_sign = false;
-    result += '-';
+/* Writes the decimal representation of value to stream, passing it on in
+   pieces of at most 4096 characters; returns false if writing failed.  */
+bool IntegerOps::write (FILE* stream, const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerOps::write(FILE*, const IntegerView&)", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::write(FILE*, const IntegerView&)] Argument `value' needs to have at most %d cells.\n", m_size);
   }
+#endif
 
-  if (eighteenDigitBlocks > 64) {
-    int64_t* parts = (int64_t*) malloc (sizeof (int64_t) * eighteenDigitBlocks);
-    toString (result, parts, temp);
-    free (parts);
-  } else {
-    int64_t parts[64];
-    toString (result, parts, temp);
+  char buf[4096];
+  DigitOutput dst (buf, buf + sizeof (buf), stream, nullptr);
+  toChars (dst, value);
+  return dst.flush ();
+}
+
+/* As write (FILE*, const IntegerView&); failures set the stream's badbit.  */
+std::ostream& IntegerOps::write (std::ostream& stream, const IntegerView& value) {
+  VALIDATE_INTEGER ("IntegerOps::write(std::ostream&, const IntegerView&)", value, LOC_BEFORE);
+#ifdef DEBUG_MODE
+  if (value.m_max > m_size) {
+    PRINT_MESSAGE_AND_EXIT ("[IntegerOps::write(std::ostream&, const IntegerView&)] Argument `value' needs to have at most %d cells.\n", m_size);
   }
-  return result;
+#endif
+
+  char buf[4096];
+  DigitOutput dst (buf, buf + sizeof (buf), nullptr, &stream);
+  toChars (dst, value);
+  dst.flush ();
+  return stream;
 }
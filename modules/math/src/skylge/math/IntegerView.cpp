@@ -0,0 +1,55 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <skylge/math/IntegerView.h>
+#include "defs.h"
+
+/* Views the value in cells[0..length), which may have leading zero cells,
+   with the given sign.  */
+IntegerView::IntegerView (const uint64_t* cells, int length, bool sign) : m_buf (cells) {
+  while (length > 0 && cells[length - 1] == 0) {
+    --length;
+  }
+  m_max = length;
+  m_sign = length > 0 && sign;
+}
+
+/* As Integer::bsr.  */
+int IntegerView::bsr (void) const {
+  return m_max > 0 ? CAL_B * m_max - calClz (m_buf[m_max - 1]) : 0;
+}
+
+const uint64_t* IntegerView::buf (void) const {
+  return m_buf;
+}
+
+int IntegerView::max (void) const {
+  return m_max;
+}
+
+bool IntegerView::sign (void) const {
+  return m_sign;
+}
+
+#ifdef DEBUG_MODE
+/* A view has no spare cells; for VALIDATE_INTEGER.  */
+int IntegerView::size (void) const {
+  return m_max;
+}
+#endif
@@ -0,0 +1,324 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "Ntt.h"
+#include "TaskPool.h"
+
+#ifdef __SIZEOF_INT128__
+
+/* The primes 29 2^57 + 1, 27 2^56 + 1 and 69 2^55 + 1 and a primitive root of
+   each, so transforms of up to 2^55 points exist modulo all three. Their
+   product lies between 2^183.72 and 2^183.73. The coefficients of a product,
+   less than min (an, bn) 2^(2 CAL_B), stay below it for a smaller operand of
+   up to 2^55 cells when CAL_B is 64. The transform length is at most
+   2 m_size (see Scratch::ntt), and OPS_MAX_SIZE (8192 cells) bounds m_size,
+   so operands stay far below either limit.  */
+static const uint64_t PRIMES[3] = {0x3A00000000000001, 0x1B00000000000001, 0x2280000000000001};
+static const uint64_t ROOTS[3] = {3, 5, 5};
+
+static inline uint64_t addMod (uint64_t a, uint64_t b, uint64_t p) {
+  uint64_t result = a + b;
+  return result >= p ? result - p : result;
+}
+
+static inline uint64_t subMod (uint64_t a, uint64_t b, uint64_t p) {
+  return a >= b ? a - b : a - b + p;
+}
+
+/* Returns a b 2^-64 mod p for a b < p 2^64.  */
+static inline uint64_t montMul (uint64_t a, uint64_t b, uint64_t p, uint64_t pinv) {
+  unsigned __int128 t = (unsigned __int128) a * b;
+  uint64_t m = (uint64_t) t * pinv;
+  uint64_t result = (uint64_t) ((t + (unsigned __int128) m * p) >> 64);
+  return result >= p ? result - p : result;
+}
+
+static int transformLength (int len) {
+  int result = 4;
+  while (result < len) {
+    result <<= 1;
+  }
+  return result;
+}
+
+static uint64_t powMod (uint64_t base, uint64_t exponent, uint64_t p) {
+  uint64_t result = 1;
+  while (exponent > 0) {
+    if ((exponent & 1) != 0) {
+      result = (unsigned __int128) result * base % p;
+    }
+    base = (unsigned __int128) base * base % p;
+    exponent >>= 1;
+  }
+  return result;
+}
+
+Ntt::Ntt (int maxLength) : m_maxLength (transformLength (maxLength)) {
+  const int n = m_maxLength;
+  for (int q = 0; q < 3; ++q) {
+    Prime& prime = m_primes[q];
+    uint64_t p = PRIMES[q];
+    uint64_t inv = p;
+    for (int i = 0; i < 5; ++i) {
+      inv *= 2 - p * inv;
+    }
+    prime.p = p;
+    prime.pinv = 0 - inv;
+    prime.r = (0 - p) % p;
+    prime.r2 = (unsigned __int128) prime.r * prime.r % p;
+
+    /* The roots of order L are every other root of order 2L.  */
+    uint64_t* roots = (uint64_t*) malloc ((uint64_t) n << 4);
+    uint64_t w = montMul (powMod (ROOTS[q], (p - 1) / n, p), prime.r2, p, prime.pinv);
+    roots[n] = prime.r;
+    for (int i = 1; i < n; ++i) {
+      roots[n + i] = montMul (roots[n + i - 1], w, p, prime.pinv);
+    }
+    for (int len = n >> 1; len > 1; len >>= 1) {
+      for (int i = 0; i < len; ++i) {
+        roots[len + i] = roots[2 * len + 2 * i];
+      }
+    }
+    prime.roots = roots;
+  }
+
+  const uint64_t p0 = PRIMES[0];
+  const uint64_t p1 = PRIMES[1];
+  const uint64_t p2 = PRIMES[2];
+  m_inverse01 = montMul (powMod (p0 % p1, p1 - 2, p1), m_primes[1].r2, p1, m_primes[1].pinv);
+  m_inverse02 = montMul (powMod (p0 % p2, p2 - 2, p2), m_primes[2].r2, p2, m_primes[2].pinv);
+  m_inverse12 = montMul (powMod (p1 % p2, p2 - 2, p2), m_primes[2].r2, p2, m_primes[2].pinv);
+
+  m_data = (uint64_t*) malloc ((uint64_t) 6 * n << 3);
+}
+
+Ntt::~Ntt (void) {
+  for (int q = 0; q < 3; ++q) {
+    free (m_primes[q].roots);
+  }
+  free (m_data);
+}
+
+/* Radix-4 decimation in frequency, natural order in, bit-reversed order out.  */
+void Ntt::forward (uint64_t* x, int n, const Prime& prime) const {
+  const uint64_t p = prime.p;
+  const uint64_t pinv = prime.pinv;
+  int len = n;
+  while (len >= 4) {
+    const int m = len >> 2;
+    const uint64_t* w = prime.roots + len;
+    const uint64_t im = w[m];
+    for (uint64_t* block = x; block < x + n; block += len) {
+      for (int j = 0; j < m; ++j) {
+        uint64_t a0 = block[j];
+        uint64_t a1 = block[j + m];
+        uint64_t a2 = block[j + 2 * m];
+        uint64_t a3 = block[j + 3 * m];
+        uint64_t t0 = addMod (a0, a2, p);
+        uint64_t t1 = addMod (a1, a3, p);
+        uint64_t t2 = subMod (a0, a2, p);
+        uint64_t t3 = montMul (subMod (a1, a3, p), im, p, pinv);
+        block[j] = addMod (t0, t1, p);
+        block[j + m] = montMul (subMod (t0, t1, p), w[2 * j], p, pinv);
+        block[j + 2 * m] = montMul (addMod (t2, t3, p), w[j], p, pinv);
+        block[j + 3 * m] = montMul (subMod (t2, t3, p), w[3 * j], p, pinv);
+      }
+    }
+    len >>= 2;
+  }
+  if (len == 2) {
+    for (int j = 0; j < n; j += 2) {
+      uint64_t a0 = x[j];
+      uint64_t a1 = x[j + 1];
+      x[j] = addMod (a0, a1, p);
+      x[j + 1] = subMod (a0, a1, p);
+    }
+  }
+}
+
+/* Radix-4 decimation in time, bit-reversed order in, natural order out. The
+   result is scaled by n.  */
+void Ntt::inverse (uint64_t* x, int n, const Prime& prime) const {
+  const uint64_t p = prime.p;
+  const uint64_t pinv = prime.pinv;
+  int len = 4;
+  if ((n & 0x55555555) == 0) {
+    for (int j = 0; j < n; j += 2) {
+      uint64_t a0 = x[j];
+      uint64_t a1 = x[j + 1];
+      x[j] = addMod (a0, a1, p);
+      x[j + 1] = subMod (a0, a1, p);
+    }
+    len = 8;
+  }
+  while (len <= n) {
+    const int m = len >> 2;
+    const int mask = len - 1;
+    const uint64_t* w = prime.roots + len;
+    for (uint64_t* block = x; block < x + n; block += len) {
+      for (int j = 0; j < m; ++j) {
+        uint64_t w2 = w[(len - 2 * j) & mask];
+        uint64_t c1 = montMul (block[j + m], w2, p, pinv);
+        uint64_t c3 = montMul (block[j + 3 * m], w2, p, pinv);
+        uint64_t b0 = addMod (block[j], c1, p);
+        uint64_t b1 = subMod (block[j], c1, p);
+        uint64_t b2 = addMod (block[j + 2 * m], c3, p);
+        uint64_t b3 = subMod (block[j + 2 * m], c3, p);
+        uint64_t d2 = montMul (b2, w[(len - j) & mask], p, pinv);
+        uint64_t d3 = montMul (b3, w[len - j - m], p, pinv);
+        block[j] = addMod (b0, d2, p);
+        block[j + 2 * m] = subMod (b0, d2, p);
+        block[j + m] = addMod (b1, d3, p);
+        block[j + 3 * m] = subMod (b1, d3, p);
+      }
+    }
+    len <<= 2;
+  }
+}
+
+/* Stores src[0..len) in Montgomery form in x[0..n), padded with zeroes.  */
+void Ntt::load (uint64_t* x, int n, const uint64_t* src, int len, const Prime& prime) const {
+  for (int i = 0; i < len; ++i) {
+    x[i] = montMul (src[i], prime.r2, prime.p, prime.pinv);
+  }
+  memset (x + len, 0, (uint64_t) (n - len) << 3);
+}
+
+int Ntt::maxLength (void) const {
+  return m_maxLength;
+}
+
+/* With parallel set, the six forward transforms are run as tasks of the
+   TaskPool, followed by the three pointwise products and inverse
+   transforms.  */
+void Ntt::mul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, bool parallel) {
+  const int len = an + bn;
+  const int n = transformLength (len);
+  if (parallel) {
+    TaskPool& pool = TaskPool::instance ();
+    pool.run (6, [&] (int i) {
+      const int q = i >> 1;
+      if ((i & 1) == 0) {
+        load (m_data + q * n, n, a, an, m_primes[q]);
+        forward (m_data + q * n, n, m_primes[q]);
+      } else {
+        load (m_data + (3 + q) * n, n, b, bn, m_primes[q]);
+        forward (m_data + (3 + q) * n, n, m_primes[q]);
+      }
+    });
+    pool.run (3, [&] (int q) {
+      convolve (m_data + q * n, m_data + (3 + q) * n, n, m_primes[q]);
+    });
+  } else {
+    for (int q = 0; q < 3; ++q) {
+      transform (m_data + q * n, n, a, an, b, bn, m_primes[q]);
+    }
+  }
+  reconstruct (dst, len, n);
+}
+
+void Ntt::sqr (uint64_t* dst, const uint64_t* a, int an, bool parallel) {
+  const int len = 2 * an;
+  const int n = transformLength (len);
+  if (parallel) {
+    TaskPool::instance ().run (3, [&] (int q) {
+      transform (m_data + q * n, n, a, an, nullptr, 0, m_primes[q]);
+    });
+  } else {
+    for (int q = 0; q < 3; ++q) {
+      transform (m_data + q * n, n, a, an, nullptr, 0, m_primes[q]);
+    }
+  }
+  reconstruct (dst, len, n);
+}
+
+/* Combines the residues of each coefficient by Garner's algorithm and
+   propagates the carries through the cells of dst[0..len).  */
+void Ntt::reconstruct (uint64_t* dst, int len, int n) {
+  const Prime& prime1 = m_primes[1];
+  const Prime& prime2 = m_primes[2];
+  const uint64_t p0 = m_primes[0].p;
+  const uint64_t p1 = prime1.p;
+  const uint64_t p2 = prime2.p;
+  const uint64_t* r0 = m_data;
+  const uint64_t* r1 = m_data + n;
+  const uint64_t* r2 = m_data + 2 * n;
+
+  unsigned __int128 carry = 0;
+  uint64_t carryHigh = 0;
+  for (int i = 0; i < len; ++i) {
+    uint64_t v0 = r0[i];
+    uint64_t v1 = montMul (subMod (r1[i], v0 % p1, p1), m_inverse01, p1, prime1.pinv);
+    uint64_t v2 = montMul (subMod (r2[i], v0 % p2, p2), m_inverse02, p2, prime2.pinv);
+    v2 = montMul (subMod (v2, v1, p2), m_inverse12, p2, prime2.pinv);
+
+    /* x = v0 + p0 (v1 + p1 v2) < 2^185  */
+    unsigned __int128 t = (unsigned __int128) p1 * v2 + v1;
+    unsigned __int128 low = (unsigned __int128) p0 * (uint64_t) t + v0;
+    unsigned __int128 high = (unsigned __int128) p0 * (uint64_t) (t >> 64) + (uint64_t) (low >> 64);
+    unsigned __int128 x = (uint64_t) low | high << 64;
+    carry += x;
+    carryHigh += (uint64_t) (high >> 64) + (carry < x);
+    dst[i] = (uint64_t) carry & CAL_LMASK[0];
+#if CAL_B < 64
+    carry = carry >> CAL_B | (unsigned __int128) carryHigh << (128 - CAL_B);
+    carryHigh >>= CAL_B;
+#else
+    carry = carry >> 64 | (unsigned __int128) carryHigh << 64;
+    carryHigh = 0;
+#endif
+  }
+}
+
+/* Stores the cyclic convolution of a and b modulo prime.p in dst[0..n); with
+   b null, that of a with itself. The second operand is transformed in the
+   n cells following those of the third prime, at an offset of 3 n from
+   dst.  */
+void Ntt::transform (uint64_t* dst, int n, const uint64_t* a, int an, const uint64_t* b, int bn, const Prime& prime) {
+  uint64_t* y = dst + 3 * n;
+  load (dst, n, a, an, prime);
+  forward (dst, n, prime);
+  if (b == nullptr) {
+    y = dst;
+  } else {
+    load (y, n, b, bn, prime);
+    forward (y, n, prime);
+  }
+  convolve (dst, y, n, prime);
+}
+
+/* Multiplies the transforms x and y pointwise into x and transforms the
+   result back; y may be x.  */
+void Ntt::convolve (uint64_t* x, const uint64_t* y, int n, const Prime& prime) const {
+  const uint64_t p = prime.p;
+  const uint64_t pinv = prime.pinv;
+
+  /* The Montgomery factors of the loaded operands and of the product cancel
+     against each other, leaving n^-1 = p - (p - 1) / n in plain form.  */
+  const uint64_t ninv = p - (p - 1) / n;
+  for (int i = 0; i < n; ++i) {
+    x[i] = montMul (montMul (x[i], y[i], p, pinv), ninv, p, pinv);
+  }
+  inverse (x, n, prime);
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__NTT_INCLUDED
+#define SKYLGE__MATH__NTT_INCLUDED
+
+#include <stdint.h>
+
+/* Operand size (in cells of the smaller operand) from which multiplication
+   switches from Toom-4 to number-theoretic transforms.  */
+#ifndef NTT_THRESHOLD
+# define NTT_THRESHOLD 2048
+#endif
+
+/* Operand size (in cells of the smaller operand) from which the transforms
+   of a product are spread over threads, if IntegerOps::setThreads allows
+   this.  */
+#ifndef NTT_PARALLEL_THRESHOLD
+# define NTT_PARALLEL_THRESHOLD 4096
+#endif
+
+/* Multiplication of arrays of cells by number-theoretic transforms modulo
+   three primes below 2^62. Each cell is taken as a coefficient, so the
+   coefficients of the product are less than min (an, bn) 2^(2 CAL_B), which
+   are reconstructed from their residues by the Chinese remainder theorem.
+   The tables of roots of unity are computed once, for transforms up to the
+   length given at construction.  */
+class Ntt {
+private:
+  struct Prime {
+    uint64_t p;
+    uint64_t pinv;    /* -p^-1 mod 2^64  */
+    uint64_t r;       /* 2^64 mod p  */
+    uint64_t r2;      /* 2^128 mod p  */
+    uint64_t* roots;  /* Roots of unity of order L at [L, 2L), Montgomery form.  */
+  };
+
+  Prime m_primes[3];
+  uint64_t m_inverse01;    /* p0^-1 mod p1, Montgomery form.  */
+  uint64_t m_inverse02;    /* p0^-1 mod p2, Montgomery form.  */
+  uint64_t m_inverse12;    /* p1^-1 mod p2, Montgomery form.  */
+  uint64_t* m_data;
+  const int m_maxLength;
+
+public:
+  explicit Ntt (int maxLength);
+  Ntt (const Ntt&) = delete;
+  Ntt (Ntt&&) = delete;
+  virtual ~Ntt (void);
+
+  Ntt& operator= (const Ntt&) = delete;
+  Ntt& operator= (Ntt&&) = delete;
+
+  int maxLength (void) const;
+  /* dst[0..an+bn) = a * b, where an + bn <= maxLength (). dst may not overlap
+     a or b. With parallel set, the transforms are run on the TaskPool.  */
+  void mul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, bool parallel = false);
+  /* dst[0..2an) = a^2, where 2an <= maxLength (), with one forward transform
+     less than mul. dst may not overlap a.  */
+  void sqr (uint64_t* dst, const uint64_t* a, int an, bool parallel = false);
+
+private:
+  void convolve (uint64_t* x, const uint64_t* y, int n, const Prime& prime) const;
+  void forward (uint64_t* x, int n, const Prime& prime) const;
+  void inverse (uint64_t* x, int n, const Prime& prime) const;
+  void load (uint64_t* x, int n, const uint64_t* src, int len, const Prime& prime) const;
+  void reconstruct (uint64_t* dst, int len, int n);
+  void transform (uint64_t* dst, int n, const uint64_t* a, int an, const uint64_t* b, int bn, const Prime& prime);
+};
+
+#endif
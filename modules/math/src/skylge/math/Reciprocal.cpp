@@ -0,0 +1,41 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+#include <skylge/math/Reciprocal.h>
+
+Reciprocal::Reciprocal (int size) : m_size (size), m_shift (0), m_sign (false) {
+  m_buf = (uint64_t*) malloc (2 * size + 1 << 3);
+}
+
+Reciprocal::Reciprocal (const Reciprocal& other) : m_size (other.m_size), m_shift (other.m_shift), m_sign (other.m_sign) {
+  size_t bsize = 2 * m_size + 1 << 3;
+  m_buf = (uint64_t*) malloc (bsize);
+  memcpy (m_buf, other.m_buf, bsize);
+}
+
+Reciprocal::Reciprocal (Reciprocal&& other) : m_buf (other.m_buf), m_size (other.m_size), m_shift (other.m_shift), m_sign (other.m_sign) {
+  other.m_buf = NULL;
+}
+
+Reciprocal::~Reciprocal (void) {
+  if (m_buf != NULL)
+    free (m_buf);
+}
@@ -0,0 +1,85 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include "defs.h"
+#include "limbs.h"
+#include "Ntt.h"
+#include "Scratch.h"
+
+Scratch::Scratch (int size) : m_mul (nullptr), m_div (nullptr), m_newton (nullptr), m_ntt (nullptr), m_size (0) {
+  reserve (size);
+}
+
+Scratch::~Scratch (void) {
+  release ();
+}
+
+/* Scratch of the divisions, parse, toString and the byte and radix
+   conversions: 2 size + 2 wordCells + Limbs::divScratchSize (size) cells.  */
+uint64_t* Scratch::div (void) {
+  return m_div;
+}
+
+/* Scratch of Limbs::mul and Limbs::sqr for operands of up to size + 1 cells.  */
+uint64_t* Scratch::mul (void) {
+  return m_mul;
+}
+
+/* Scratch of newtonDiv, createReciprocal, parse and toString, only allocated once needed.  */
+uint64_t* Scratch::newton (void) {
+  if (m_newton == nullptr) {
+    m_newton = (uint64_t*) malloc (8 * m_size + 64 + Limbs::divScratchSize (m_size) << 3);
+  }
+  return m_newton;
+}
+
+#ifdef __SIZEOF_INT128__
+/* The transforms and their tables are only set up once a product needs them.  */
+Ntt& Scratch::ntt (void) {
+  if (m_ntt == nullptr) {
+    m_ntt = new Ntt (2 * m_size);
+  }
+  return *m_ntt;
+}
+#endif
+
+/* Makes the scratch space suffice for operands of size cells; it only grows.  */
+void Scratch::reserve (const int size) {
+  if (size <= m_size)
+    return;
+
+  release ();
+  m_size = size;
+  m_mul = (uint64_t*) malloc (Limbs::mulScratchSize (size + 1) << 3);
+  m_div = (uint64_t*) malloc (2 * size + 2 * wordCells + Limbs::divScratchSize (size) << 3);
+}
+
+int Scratch::size (void) const {
+  return m_size;
+}
+
+void Scratch::release (void) {
+  free (m_mul);
+  free (m_div);
+  free (m_newton);
+  delete m_ntt;
+  m_newton = nullptr;
+  m_ntt = nullptr;
+}
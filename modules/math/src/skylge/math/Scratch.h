@@ -0,0 +1,63 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__SCRATCH_INCLUDED
+#define SKYLGE__MATH__SCRATCH_INCLUDED
+
+#include <stdint.h>
+
+class Ntt;
+
+/* The scratch space IntegerOps needs for operands of up to a given size.
+   That of newtonDiv and of the transforms is only allocated once needed.
+   An IntegerOps normally has one of its own; those SharedIntegerOps creates
+   for a thread share one, grown to the largest of their sizes, which is
+   possible because a thread does one operation at a time. Growing moves
+   the buffers, so they are looked up again for each operation.  */
+class Scratch {
+private:
+  uint64_t* m_mul;
+  uint64_t* m_div;
+  uint64_t* m_newton;
+  Ntt* m_ntt;
+  int m_size;
+
+public:
+  explicit Scratch (int size);
+  Scratch (const Scratch&) = delete;
+  Scratch (Scratch&&) = delete;
+  ~Scratch (void);
+
+  Scratch& operator= (const Scratch&) = delete;
+  Scratch& operator= (Scratch&&) = delete;
+
+  uint64_t* div (void);
+  uint64_t* mul (void);
+  uint64_t* newton (void);
+#ifdef __SIZEOF_INT128__
+  Ntt& ntt (void);
+#endif
+  void reserve (int size);
+  int size (void) const;
+
+private:
+  void release (void);
+};
+
+#endif
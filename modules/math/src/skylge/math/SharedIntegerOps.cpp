@@ -0,0 +1,302 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <skylge/math/SharedIntegerOps.h>
+#include "defs.h"
+#include "errors.h"
+#include "Scratch.h"
+
+/* The IntegerOps a SharedIntegerOps has created, one for each thread that
+   used it, each with the scratch space it shares with the other IntegerOps
+   of its thread. They are deleted with the SharedIntegerOps, or before
+   that when their thread exits.  */
+struct SharedIntegerOps::Instances {
+  std::mutex mutex;
+  std::vector<IntegerOps*> ops;
+  std::vector<std::shared_ptr<Scratch>> scratch;
+
+  ~Instances (void);
+
+  IntegerOps* add (int size, const std::shared_ptr<Scratch>& threadScratch);
+  void remove (IntegerOps* threadOps);
+};
+
+/* The IntegerOps a thread has got from SharedIntegerOps, one per object,
+   and the scratch space they share while any of them exists.  */
+class ThreadIntegerOps {
+private:
+  struct Entry {
+    uint64_t id;
+    IntegerOps* ops;
+    std::weak_ptr<SharedIntegerOps::Instances> instances;
+  };
+
+  std::vector<Entry> m_entries;
+  std::weak_ptr<Scratch> m_scratch;
+  size_t m_last;
+
+public:
+  ThreadIntegerOps (void);
+  ~ThreadIntegerOps (void);
+
+  IntegerOps& get (const SharedIntegerOps& owner);
+};
+
+static std::atomic<uint64_t> nextId (1);
+static thread_local ThreadIntegerOps threadOps;
+
+SharedIntegerOps::Instances::~Instances (void) {
+  for (size_t i = 0; i < ops.size (); ++i) {
+    delete ops[i];
+  }
+}
+
+IntegerOps* SharedIntegerOps::Instances::add (const int size, const std::shared_ptr<Scratch>& threadScratch) {
+  IntegerOps* result = new IntegerOps (size, threadScratch.get ());
+  std::lock_guard<std::mutex> lock (mutex);
+  ops.push_back (result);
+  scratch.push_back (threadScratch);
+  return result;
+}
+
+void SharedIntegerOps::Instances::remove (IntegerOps* threadOps) {
+  std::lock_guard<std::mutex> lock (mutex);
+  size_t i = 0;
+  while (ops[i] != threadOps) {
+    ++i;
+  }
+  delete ops[i];
+  ops.erase (ops.begin () + i);
+  scratch.erase (scratch.begin () + i);
+}
+
+ThreadIntegerOps::ThreadIntegerOps (void) : m_last (0) {
+}
+
+ThreadIntegerOps::~ThreadIntegerOps (void) {
+  for (size_t i = 0; i < m_entries.size (); ++i) {
+    std::shared_ptr<SharedIntegerOps::Instances> instances = m_entries[i].instances.lock ();
+    if (instances) {
+      instances->remove (m_entries[i].ops);
+    }
+  }
+}
+
+/* A thread mostly uses one or a few objects, so the last one found is
+   tried first and the others are searched linearly. The ids of the objects
+   are never reused, so the entries of destroyed ones, whose IntegerOps are
+   gone, are never found; they are dropped when a new entry is added.  */
+IntegerOps& ThreadIntegerOps::get (const SharedIntegerOps& owner) {
+  if (m_last < m_entries.size () && m_entries[m_last].id == owner.m_id)
+    return *m_entries[m_last].ops;
+
+  size_t i = 0;
+  while (i < m_entries.size () && m_entries[i].id != owner.m_id) {
+    ++i;
+  }
+  if (i == m_entries.size ()) {
+    size_t j = 0;
+    while (j < m_entries.size ()) {
+      if (m_entries[j].instances.expired ()) {
+        m_entries.erase (m_entries.begin () + j);
+      } else {
+        ++j;
+      }
+    }
+
+    std::shared_ptr<Scratch> scratch = m_scratch.lock ();
+    if (scratch) {
+      scratch->reserve (owner.m_size);
+    } else {
+      scratch = std::make_shared<Scratch> (owner.m_size);
+      m_scratch = scratch;
+    }
+    m_entries.push_back ({owner.m_id, owner.m_instances->add (owner.m_size, scratch), owner.m_instances});
+    i = m_entries.size () - 1;
+  }
+  m_last = i;
+  return *m_entries[i].ops;
+}
+
+/* Returns a copy of value in an Integer of as many cells as it has.  */
+static Integer fitted (const IntegerView& value) {
+  Integer result (value.max () > OPS_MIN_SIZE ? value.max () : OPS_MIN_SIZE);
+  result = value;
+  return result;
+}
+
+SharedIntegerOps::SharedIntegerOps (int size) : m_size (size), m_id (nextId++), m_instances (new Instances) {
+#ifdef DEBUG_MODE
+  if (size < OPS_MIN_SIZE || size > OPS_MAX_SIZE) {
+    PRINT_MESSAGE_AND_EXIT ("[SharedIntegerOps::SharedIntegerOps(int)] The specified size (%d) is out of range. It should be: %d < size < %d.\n", size, OPS_MIN_SIZE - 1, OPS_MAX_SIZE + 1);
+  }
+#endif
+}
+
+/* No thread should be using the object any more.  */
+SharedIntegerOps::~SharedIntegerOps (void) {
+}
+
+bool SharedIntegerOps::add (Integer& dst, const Integer& src) const {
+  return local ().add (dst, src);
+}
+
+bool SharedIntegerOps::add (Integer& dst, const IntegerView& src) const {
+  return local ().add (dst, src);
+}
+
+bool SharedIntegerOps::add (Integer& dst, int value) const {
+  return local ().add (dst, value);
+}
+
+bool SharedIntegerOps::add (IntegerBatch& dst, const IntegerBatch& src) const {
+  return local ().add (dst, src);
+}
+
+Integer SharedIntegerOps::createInteger (int64_t value) const {
+  Integer result (m_size);
+  result = value;
+  return result;
+}
+
+Reciprocal SharedIntegerOps::createReciprocal (const IntegerView& denominator) const {
+  return local ().createReciprocal (denominator);
+}
+
+bool SharedIntegerOps::dec (Integer& dst) const {
+  return local ().dec (dst);
+}
+
+size_t SharedIntegerOps::decimalLength (const IntegerView& value) const {
+  return local ().decimalLength (value);
+}
+
+/* Returns the remainder.  */
+Integer SharedIntegerOps::div (Integer& dst, const IntegerView& src) const {
+  return local ().div (dst, src);
+}
+
+/* Returns the remainder.  */
+Integer SharedIntegerOps::div (Integer& dst, const Reciprocal& denominator) const {
+  return local ().div (dst, denominator);
+}
+
+uint64_t SharedIntegerOps::divmod (Integer& dst, uint64_t value) const {
+  return local ().divmod (dst, value);
+}
+
+size_t SharedIntegerOps::exportBytes (void* dst, const IntegerView& value, int order, size_t size, int endian) const {
+  return local ().exportBytes (dst, value, order, size, endian);
+}
+
+bool SharedIntegerOps::fromHex (const char* str, size_t length, Integer& dst) const {
+  return local ().fromHex (str, length, dst);
+}
+
+bool SharedIntegerOps::fromRadix (const char* str, size_t length, int bits, Integer& dst) const {
+  return local ().fromRadix (str, length, bits, dst);
+}
+
+Integer SharedIntegerOps::fromString (const std::string& str) const {
+  return local ().fromString (str);
+}
+
+bool SharedIntegerOps::importBytes (Integer& dst, const void* src, size_t count, int order, size_t size, int endian) const {
+  return local ().importBytes (dst, src, count, order, size, endian);
+}
+
+bool SharedIntegerOps::inc (Integer& dst) const {
+  return local ().inc (dst);
+}
+
+/* Returns the IntegerOps of the calling thread. Its results that are
+   returned by reference are valid until that thread's next operation with
+   this object.  */
+IntegerOps& SharedIntegerOps::local (void) const {
+  return threadOps.get (*this);
+}
+
+uint64_t SharedIntegerOps::mod (const IntegerView& src, uint64_t value) const {
+  return local ().mod (src, value);
+}
+
+/* Returns the product in an Integer of as many cells as it has.  */
+Integer SharedIntegerOps::mul (const IntegerView& srcA, const IntegerView& srcB) const {
+  return fitted (local ().mul (srcA, srcB));
+}
+
+void SharedIntegerOps::mul (IntegerBatch& dst, const IntegerBatch& srcA, const IntegerBatch& srcB) const {
+  local ().mul (dst, srcA, srcB);
+}
+
+bool SharedIntegerOps::mulWord (Integer& dst, uint64_t value) const {
+  return local ().mulWord (dst, value);
+}
+
+bool SharedIntegerOps::parse (const char* str, size_t length, Integer& dst) const {
+  return local ().parse (str, length, dst);
+}
+
+size_t SharedIntegerOps::radixLength (const IntegerView& value, int bits) const {
+  return local ().radixLength (value, bits);
+}
+
+int SharedIntegerOps::size (void) const {
+  return m_size;
+}
+
+/* Returns the square in an Integer of as many cells as it has.  */
+Integer SharedIntegerOps::sqr (const IntegerView& src) const {
+  return fitted (local ().sqr (src));
+}
+
+bool SharedIntegerOps::sub (Integer& dst, const IntegerView& src) const {
+  return local ().sub (dst, src);
+}
+
+bool SharedIntegerOps::sub (IntegerBatch& dst, const IntegerBatch& src) const {
+  return local ().sub (dst, src);
+}
+
+std::string SharedIntegerOps::toHex (const IntegerView& value) const {
+  return local ().toHex (value);
+}
+
+size_t SharedIntegerOps::toChars (char* first, char* last, const IntegerView& value) const {
+  return local ().toChars (first, last, value);
+}
+
+size_t SharedIntegerOps::toRadix (char* dst, const IntegerView& value, int bits) const {
+  return local ().toRadix (dst, value, bits);
+}
+
+std::string SharedIntegerOps::toString (const IntegerView& value) const {
+  return local ().toString (value);
+}
+
+bool SharedIntegerOps::write (FILE* stream, const IntegerView& value) const {
+  return local ().write (stream, value);
+}
+
+std::ostream& SharedIntegerOps::write (std::ostream& stream, const IntegerView& value) const {
+  return local ().write (stream, value);
+}
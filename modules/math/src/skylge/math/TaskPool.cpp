@@ -0,0 +1,117 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "TaskPool.h"
+
+struct TaskPool::Batch {
+  const std::function<void (int)>* task;
+  int count;
+  int next;
+  int done;
+  std::condition_variable finished;
+};
+
+TaskPool::TaskPool (void) {
+}
+
+TaskPool& TaskPool::instance (void) {
+  /* Never deleted: the workers run until the process exits.  */
+  static TaskPool* pool = new TaskPool ();
+  return *pool;
+}
+
+void TaskPool::reserve (int count) {
+  std::lock_guard<std::mutex> lock (m_mutex);
+  while ((int) m_workers.size () < count) {
+    m_workers.emplace_back (&TaskPool::work, this);
+    m_workers.back ().detach ();
+  }
+}
+
+void TaskPool::run (int count, const std::function<void (int)>& task) {
+  Batch batch;
+  batch.task = &task;
+  batch.count = count;
+  batch.next = 0;
+  batch.done = 0;
+
+  std::unique_lock<std::mutex> lock (m_mutex);
+  if (count <= 1 || m_workers.empty ()) {
+    lock.unlock ();
+    for (int i = 0; i < count; ++i) {
+      task (i);
+    }
+    return;
+  }
+  m_batches.push_back (&batch);
+  m_pending.notify_all ();
+
+  for (int i = claim (batch); i >= 0; i = claim (batch)) {
+    execute (batch, i, lock);
+  }
+  while (batch.done < batch.count) {
+    batch.finished.wait (lock);
+  }
+}
+
+/* Returns the index of the next task of batch and takes the batch off the
+   queue once all its tasks have been claimed, or returns -1 if none is left.
+   Called with m_mutex locked.  */
+int TaskPool::claim (Batch& batch) {
+  if (batch.next == batch.count)
+    return -1;
+  const int result = batch.next++;
+  if (batch.next == batch.count) {
+    for (auto it = m_batches.begin (); it != m_batches.end (); ++it) {
+      if (*it == &batch) {
+        m_batches.erase (it);
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+/* Runs task i of batch with m_mutex unlocked. The batch may not be used once
+   its last task is counted as done, as its submitter then returns.  */
+void TaskPool::execute (Batch& batch, int i, std::unique_lock<std::mutex>& lock) {
+  lock.unlock ();
+  (*batch.task) (i);
+  lock.lock ();
+  ++batch.done;
+  if (batch.done == batch.count) {
+    batch.finished.notify_all ();
+  }
+}
+
+int TaskPool::workers (void) {
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return (int) m_workers.size ();
+}
+
+void TaskPool::work (void) {
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true) {
+    while (m_batches.empty ()) {
+      m_pending.wait (lock);
+    }
+    Batch& batch = *m_batches.front ();
+    execute (batch, claim (batch), lock);
+  }
+}
@@ -0,0 +1,68 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__TASK_POOL_INCLUDED
+#define SKYLGE__MATH__TASK_POOL_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Worker threads, shared by the whole process, that run batches of
+   independent tasks. Idle workers take tasks from any pending batch, and
+   the thread that submits a batch runs its tasks too until none are left,
+   so batches may be submitted from within tasks.  */
+class TaskPool {
+private:
+  struct Batch;
+
+  std::vector<std::thread> m_workers;
+  std::deque<Batch*> m_batches;
+  std::mutex m_mutex;
+  std::condition_variable m_pending;
+
+  TaskPool (void);
+
+public:
+  TaskPool (const TaskPool&) = delete;
+  TaskPool (TaskPool&&) = delete;
+
+  TaskPool& operator= (const TaskPool&) = delete;
+  TaskPool& operator= (TaskPool&&) = delete;
+
+  /* Makes sure there are at least count workers.  */
+  void reserve (int count);
+
+  /* Runs task (i) for 0 <= i < count and returns once all are done.  */
+  void run (int count, const std::function<void (int)>& task);
+
+  int workers (void);
+
+  static TaskPool& instance (void);
+
+private:
+  int claim (Batch& batch);
+  void execute (Batch& batch, int i, std::unique_lock<std::mutex>& lock);
+  void work (void);
+};
+
+#endif
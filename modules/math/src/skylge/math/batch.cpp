@@ -0,0 +1,193 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "batch.h"
+#include "defs.h"
+
+#if defined (__x86_64__) && defined (__linux__) && defined (__has_attribute)
+# if __has_attribute (target_clones)
+#  define BATCH_CLONES __attribute__ ((target_clones ("avx512f", "avx2", "default")))
+# endif
+#endif
+#ifndef BATCH_CLONES
+# define BATCH_CLONES
+#endif
+
+#if CAL_B == 64
+# define CELL_MASK (~(uint64_t) 0)
+#else
+# define CELL_MASK (((uint64_t) 1 << CAL_B) - 1)
+#endif
+
+/* The cell functions of defs.h, written without branches or carry flags so
+   that they vectorise: carries and borrows are 0 or 1.  */
+
+static inline uint64_t addCell (uint64_t a, uint64_t b, uint64_t& carry) {
+#if CAL_B == 64
+  const uint64_t sum = a + b;
+  const uint64_t result = sum + carry;
+  carry = (uint64_t) (sum < a) | (uint64_t) (result < sum);
+  return result;
+#else
+  const uint64_t result = a + b + carry;
+  carry = result >> CAL_B;
+  return result & CELL_MASK;
+#endif
+}
+
+static inline uint64_t subCell (uint64_t a, uint64_t b, uint64_t& borrow) {
+#if CAL_B == 64
+  const uint64_t diff = a - b;
+  const uint64_t result = diff - borrow;
+  borrow = (uint64_t) (a < b) | (uint64_t) (diff < borrow);
+  return result;
+#else
+  const uint64_t result = a - b - borrow;
+  borrow = result >> 63;
+  return result & CELL_MASK;
+#endif
+}
+
+/* As calMulAdd. For CAL_B = 64 the product is assembled from four 32 bit
+   products, as vector units have no 64 bit multiplication with a high
+   part.  */
+static inline uint64_t mulAddCell (uint64_t a, uint64_t b, uint64_t c, uint64_t& high) {
+#if CAL_B == 64
+  const uint64_t al = a & 0xFFFFFFFF;
+  const uint64_t ah = a >> 32;
+  const uint64_t bl = b & 0xFFFFFFFF;
+  const uint64_t bh = b >> 32;
+  const uint64_t ll = al * bl;
+  const uint64_t lh = al * bh;
+  const uint64_t hl = ah * bl;
+  const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+  uint64_t low = mid << 32 | ll & 0xFFFFFFFF;
+  uint64_t hi = ah * bh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  low += c;
+  hi += low < c;
+  low += high;
+  hi += low < high;
+  high = hi;
+  return low;
+#else
+  const uint64_t result = a * b + c + high;
+  high = result >> CAL_B;
+  return result & CELL_MASK;
+#endif
+}
+
+/* Both the sum and the difference of the magnitudes are computed, and each
+   lane keeps the one its signs call for; a negative difference is then
+   negated.  */
+BATCH_CLONES
+bool Batch::add (uint64_t* dst, uint64_t* dstSigns, const uint64_t* a, const uint64_t* aSigns, const uint64_t* b, const uint64_t* bSigns, const int n, const int stride, const bool negate) {
+  const uint64_t flip = negate ? ~(uint64_t) 0 : 0;
+  uint64_t overflow = 0;
+
+  for (int t = 0; t < stride; t += BATCH_TILE) {
+    uint64_t differ[BATCH_TILE];
+    uint64_t carry[BATCH_TILE];
+    uint64_t borrow[BATCH_TILE];
+    for (int i = 0; i < BATCH_TILE; ++i) {
+      differ[i] = aSigns[t + i] ^ bSigns[t + i] ^ flip;
+      carry[i] = 0;
+      borrow[i] = 0;
+    }
+
+    for (int j = 0; j < n; ++j) {
+      const uint64_t* x = a + j * stride + t;
+      const uint64_t* y = b + j * stride + t;
+      uint64_t* z = dst + j * stride + t;
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        const uint64_t sum = addCell (x[i], y[i], carry[i]);
+        const uint64_t diff = subCell (x[i], y[i], borrow[i]);
+        z[i] = sum ^ (sum ^ diff) & differ[i];
+      }
+    }
+
+    /* Lanes with a borrow out have b > a: negate, and flip the sign.  */
+    uint64_t negative[BATCH_TILE];
+    uint64_t nonzero[BATCH_TILE];
+    for (int i = 0; i < BATCH_TILE; ++i) {
+      negative[i] = differ[i] & 0 - borrow[i];
+      overflow |= ~differ[i] & carry[i];
+      carry[i] = negative[i] & 1;
+      nonzero[i] = 0;
+    }
+    for (int j = 0; j < n; ++j) {
+      uint64_t* z = dst + j * stride + t;
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        uint64_t c = 0;
+        const uint64_t x = addCell ((z[i] ^ negative[i]) & CELL_MASK, carry[i], c);
+        carry[i] = c;
+        z[i] = x;
+        nonzero[i] |= x;
+      }
+    }
+    for (int i = 0; i < BATCH_TILE; ++i) {
+      dstSigns[t + i] = (aSigns[t + i] ^ negative[i]) & 0 - (uint64_t) (nonzero[i] != 0);
+    }
+  }
+  return overflow != 0;
+}
+
+BATCH_CLONES
+void Batch::mul (uint64_t* dst, uint64_t* dstSigns, const int dstStride, const uint64_t* a, const uint64_t* aSigns, const uint64_t* b, const uint64_t* bSigns, const int n, const int stride) {
+  for (int t = 0; t < stride; t += BATCH_TILE) {
+    for (int j = 0; j < 2 * n; ++j) {
+      uint64_t* z = dst + j * dstStride + t;
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        z[i] = 0;
+      }
+    }
+
+    for (int j = 0; j < n; ++j) {
+      const uint64_t* x = a + j * stride + t;
+      uint64_t high[BATCH_TILE];
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        high[i] = 0;
+      }
+      for (int k = 0; k < n; ++k) {
+        const uint64_t* y = b + k * stride + t;
+        uint64_t* z = dst + (j + k) * dstStride + t;
+        for (int i = 0; i < BATCH_TILE; ++i) {
+          z[i] = mulAddCell (x[i], y[i], z[i], high[i]);
+        }
+      }
+      uint64_t* z = dst + (j + n) * dstStride + t;
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        z[i] = high[i];
+      }
+    }
+
+    uint64_t nonzero[BATCH_TILE];
+    for (int i = 0; i < BATCH_TILE; ++i) {
+      nonzero[i] = 0;
+    }
+    for (int j = 0; j < 2 * n; ++j) {
+      const uint64_t* z = dst + j * dstStride + t;
+      for (int i = 0; i < BATCH_TILE; ++i) {
+        nonzero[i] |= z[i];
+      }
+    }
+    for (int i = 0; i < BATCH_TILE; ++i) {
+      dstSigns[t + i] = (aSigns[t + i] ^ bSigns[t + i]) & 0 - (uint64_t) (nonzero[i] != 0);
+    }
+  }
+}
@@ -0,0 +1,48 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__BATCH_INCLUDED
+#define SKYLGE__MATH__BATCH_INCLUDED
+
+#include <stdint.h>
+
+/* Number of lanes processed together; the stride of an IntegerBatch is a
+   multiple of it.  */
+#define BATCH_TILE 32
+
+/* Routines operating on values stored limb-interleaved: cell j of lane i at
+   x[j * stride + i], with the sign of lane i at signs[i] (0 or all ones),
+   stride being a multiple of BATCH_TILE. Each lane is independent, and the
+   loops over lanes are free of branches, so that they are vectorised. On
+   x86-64, versions for AVX-512, AVX2 and plain x86-64 are compiled, one of
+   which is picked when the program is loaded.  */
+namespace Batch {
+
+  /* dst = a + b, lane by lane, or a - b with negate set, where each value
+     has n cells. dst may be a or b. Returns true if the result of any lane
+     does not fit in n cells, in which case that lane holds its lower n
+     cells (as IntegerOps::add).  */
+  bool add (uint64_t* dst, uint64_t* dstSigns, const uint64_t* a, const uint64_t* aSigns, const uint64_t* b, const uint64_t* bSigns, int n, int stride, bool negate);
+
+  /* dst = a * b, lane by lane, where a and b have n cells and dst 2n cells
+     with a stride of its own. dst may not overlap a or b.  */
+  void mul (uint64_t* dst, uint64_t* dstSigns, int dstStride, const uint64_t* a, const uint64_t* aSigns, const uint64_t* b, const uint64_t* bSigns, int n, int stride);
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "cpu.h"
+
+/* __builtin_cpu_supports uses the results of CPUID, obtained once, taking
+   XGETBV into account for the AVX-512 extensions. __builtin_cpu_init makes
+   sure they have been obtained when these are called during static
+   initialisation.  */
+
+bool Cpu::hasAdx (void) {
+#if defined (__x86_64__) && defined (__GNUC__)
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("adx");
+#else
+  return false;
+#endif
+}
+
+bool Cpu::hasBmi2 (void) {
+#if defined (__x86_64__) && defined (__GNUC__)
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("bmi2");
+#else
+  return false;
+#endif
+}
+
+bool Cpu::hasIfma (void) {
+#if defined (__x86_64__) && defined (__GNUC__)
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("avx512ifma");
+#else
+  return false;
+#endif
+}
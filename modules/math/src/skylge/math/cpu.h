@@ -0,0 +1,38 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__CPU_INCLUDED
+#define SKYLGE__MATH__CPU_INCLUDED
+
+/* Instruction set extensions of the processor the program runs on, as
+   reported by CPUID (and, for AVX-512, enabled by the operating system).
+   All return false on other architectures than x86-64.  */
+namespace Cpu {
+
+  /* Multi-precision add-carry (adcx, adox).  */
+  bool hasAdx (void);
+
+  /* Bit manipulation instructions 2 (mulx, shlx, shrx and others).  */
+  bool hasBmi2 (void);
+
+  /* AVX-512 Integer Fused Multiply-Add (vpmadd52luq, vpmadd52huq).  */
+  bool hasIfma (void);
+}
+
+#endif
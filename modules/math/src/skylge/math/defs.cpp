@@ -25,7 +25,7 @@ const uint64_t CAL_LMASK[7] = {0x3F, 0x3E, 0x3C, 0x38, 0x30, 0x20, 0x00};
 const uint64_t CAL_RMASK[7] = {0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F};
 const uint64_t CAL_SMASK[7] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40};
 
-#else
+#elif CAL_B == 32
 
 const uint64_t CAL_LMASK[33] = {0xFFFFFFFF, 0xFFFFFFFE, 0xFFFFFFFC, 0xFFFFFFF8,
                                 0xFFFFFFF0, 0xFFFFFFE0, 0xFFFFFFC0, 0xFFFFFF80,
@@ -57,4 +57,110 @@ const uint64_t CAL_SMASK[33] = {0x00000001, 0x00000002, 0x00000004, 0x00000008,
                                 0x10000000, 0x20000000, 0x40000000, 0x80000000,
                                 0x100000000};
 
+#else
+
+const uint64_t CAL_LMASK[65] = {0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFE,
+                                0xFFFFFFFFFFFFFFFC, 0xFFFFFFFFFFFFFFF8,
+                                0xFFFFFFFFFFFFFFF0, 0xFFFFFFFFFFFFFFE0,
+                                0xFFFFFFFFFFFFFFC0, 0xFFFFFFFFFFFFFF80,
+                                0xFFFFFFFFFFFFFF00, 0xFFFFFFFFFFFFFE00,
+                                0xFFFFFFFFFFFFFC00, 0xFFFFFFFFFFFFF800,
+                                0xFFFFFFFFFFFFF000, 0xFFFFFFFFFFFFE000,
+                                0xFFFFFFFFFFFFC000, 0xFFFFFFFFFFFF8000,
+                                0xFFFFFFFFFFFF0000, 0xFFFFFFFFFFFE0000,
+                                0xFFFFFFFFFFFC0000, 0xFFFFFFFFFFF80000,
+                                0xFFFFFFFFFFF00000, 0xFFFFFFFFFFE00000,
+                                0xFFFFFFFFFFC00000, 0xFFFFFFFFFF800000,
+                                0xFFFFFFFFFF000000, 0xFFFFFFFFFE000000,
+                                0xFFFFFFFFFC000000, 0xFFFFFFFFF8000000,
+                                0xFFFFFFFFF0000000, 0xFFFFFFFFE0000000,
+                                0xFFFFFFFFC0000000, 0xFFFFFFFF80000000,
+                                0xFFFFFFFF00000000, 0xFFFFFFFE00000000,
+                                0xFFFFFFFC00000000, 0xFFFFFFF800000000,
+                                0xFFFFFFF000000000, 0xFFFFFFE000000000,
+                                0xFFFFFFC000000000, 0xFFFFFF8000000000,
+                                0xFFFFFF0000000000, 0xFFFFFE0000000000,
+                                0xFFFFFC0000000000, 0xFFFFF80000000000,
+                                0xFFFFF00000000000, 0xFFFFE00000000000,
+                                0xFFFFC00000000000, 0xFFFF800000000000,
+                                0xFFFF000000000000, 0xFFFE000000000000,
+                                0xFFFC000000000000, 0xFFF8000000000000,
+                                0xFFF0000000000000, 0xFFE0000000000000,
+                                0xFFC0000000000000, 0xFF80000000000000,
+                                0xFF00000000000000, 0xFE00000000000000,
+                                0xFC00000000000000, 0xF800000000000000,
+                                0xF000000000000000, 0xE000000000000000,
+                                0xC000000000000000, 0x8000000000000000,
+                                0x0000000000000000};
+
+const uint64_t CAL_RMASK[65] = {0x0000000000000000, 0x0000000000000001,
+                                0x0000000000000003, 0x0000000000000007,
+                                0x000000000000000F, 0x000000000000001F,
+                                0x000000000000003F, 0x000000000000007F,
+                                0x00000000000000FF, 0x00000000000001FF,
+                                0x00000000000003FF, 0x00000000000007FF,
+                                0x0000000000000FFF, 0x0000000000001FFF,
+                                0x0000000000003FFF, 0x0000000000007FFF,
+                                0x000000000000FFFF, 0x000000000001FFFF,
+                                0x000000000003FFFF, 0x000000000007FFFF,
+                                0x00000000000FFFFF, 0x00000000001FFFFF,
+                                0x00000000003FFFFF, 0x00000000007FFFFF,
+                                0x0000000000FFFFFF, 0x0000000001FFFFFF,
+                                0x0000000003FFFFFF, 0x0000000007FFFFFF,
+                                0x000000000FFFFFFF, 0x000000001FFFFFFF,
+                                0x000000003FFFFFFF, 0x000000007FFFFFFF,
+                                0x00000000FFFFFFFF, 0x00000001FFFFFFFF,
+                                0x00000003FFFFFFFF, 0x00000007FFFFFFFF,
+                                0x0000000FFFFFFFFF, 0x0000001FFFFFFFFF,
+                                0x0000003FFFFFFFFF, 0x0000007FFFFFFFFF,
+                                0x000000FFFFFFFFFF, 0x000001FFFFFFFFFF,
+                                0x000003FFFFFFFFFF, 0x000007FFFFFFFFFF,
+                                0x00000FFFFFFFFFFF, 0x00001FFFFFFFFFFF,
+                                0x00003FFFFFFFFFFF, 0x00007FFFFFFFFFFF,
+                                0x0000FFFFFFFFFFFF, 0x0001FFFFFFFFFFFF,
+                                0x0003FFFFFFFFFFFF, 0x0007FFFFFFFFFFFF,
+                                0x000FFFFFFFFFFFFF, 0x001FFFFFFFFFFFFF,
+                                0x003FFFFFFFFFFFFF, 0x007FFFFFFFFFFFFF,
+                                0x00FFFFFFFFFFFFFF, 0x01FFFFFFFFFFFFFF,
+                                0x03FFFFFFFFFFFFFF, 0x07FFFFFFFFFFFFFF,
+                                0x0FFFFFFFFFFFFFFF, 0x1FFFFFFFFFFFFFFF,
+                                0x3FFFFFFFFFFFFFFF, 0x7FFFFFFFFFFFFFFF,
+                                0xFFFFFFFFFFFFFFFF};
+
+/* CAL_SMASK[64] would be 2^64, which does not fit; carries out of a 64 bit
+   cell are taken from the hardware instead (see defs.h).  */
+const uint64_t CAL_SMASK[65] = {0x0000000000000001, 0x0000000000000002,
+                                0x0000000000000004, 0x0000000000000008,
+                                0x0000000000000010, 0x0000000000000020,
+                                0x0000000000000040, 0x0000000000000080,
+                                0x0000000000000100, 0x0000000000000200,
+                                0x0000000000000400, 0x0000000000000800,
+                                0x0000000000001000, 0x0000000000002000,
+                                0x0000000000004000, 0x0000000000008000,
+                                0x0000000000010000, 0x0000000000020000,
+                                0x0000000000040000, 0x0000000000080000,
+                                0x0000000000100000, 0x0000000000200000,
+                                0x0000000000400000, 0x0000000000800000,
+                                0x0000000001000000, 0x0000000002000000,
+                                0x0000000004000000, 0x0000000008000000,
+                                0x0000000010000000, 0x0000000020000000,
+                                0x0000000040000000, 0x0000000080000000,
+                                0x0000000100000000, 0x0000000200000000,
+                                0x0000000400000000, 0x0000000800000000,
+                                0x0000001000000000, 0x0000002000000000,
+                                0x0000004000000000, 0x0000008000000000,
+                                0x0000010000000000, 0x0000020000000000,
+                                0x0000040000000000, 0x0000080000000000,
+                                0x0000100000000000, 0x0000200000000000,
+                                0x0000400000000000, 0x0000800000000000,
+                                0x0001000000000000, 0x0002000000000000,
+                                0x0004000000000000, 0x0008000000000000,
+                                0x0010000000000000, 0x0020000000000000,
+                                0x0040000000000000, 0x0080000000000000,
+                                0x0100000000000000, 0x0200000000000000,
+                                0x0400000000000000, 0x0800000000000000,
+                                0x1000000000000000, 0x2000000000000000,
+                                0x4000000000000000, 0x8000000000000000,
+                                0x0000000000000000};
+
 #endif
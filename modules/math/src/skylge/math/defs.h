@@ -21,7 +21,11 @@
 #define SKYLGE__MATH__DEFS_INCLUDED
 
 #ifndef CAL_B
-# define CAL_B 32
+# ifdef __SIZEOF_INT128__
+#  define CAL_B 64
+# else
+#  define CAL_B 32
+# endif
 #endif
 
 #include <stdint.h>
@@ -36,15 +40,156 @@
 # define CAL_Q(x) (x >> 5)
 # define CAL_R(x) (x & 0x1F)
 
+#elif CAL_B == 64
+
+# ifndef __SIZEOF_INT128__
+#  error CAL_B=64 requires a compiler with unsigned __int128
+# endif
+# ifdef __x86_64__
+#  include <x86intrin.h>
+# endif
+
+# define CAL_Q(x) (x >> 6)
+# define CAL_R(x) (x & 0x3F)
+
+#else
+# error CAL_B should be 6, 32 or 64
+#endif
+
+#if CAL_B < 64
+# define CAL_CARRY(x)       ((x & CAL_SMASK[CAL_B]) != 0)
+# define CAL_CLEAR_CARRY(x) x &= CAL_LMASK[0]
 #else
-# error CAL_B should be 6 or 32
+/* A 64 bit cell has no spare bits to hold a carry, so there is nothing to
+   clear; carries are propagated by the functions below.  */
+# define CAL_CLEAR_CARRY(x)
 #endif
 
-#define CAL_CARRY(x)       ((x & CAL_SMASK[CAL_B]) != 0)
-#define CAL_CLEAR_CARRY(x) x &= CAL_LMASK[0]
+/* Maximum number of cells of a uint64_t.  */
+static const int wordCells = (64 + CAL_B - 1) / CAL_B;
+
+/* Bounds on the size of an IntegerOps (and a SharedIntegerOps); its
+   products, of twice as many cells, still fit in an Integer.  */
+#define OPS_MAX_SIZE 8192
+#define OPS_MIN_SIZE 2
 
 extern const uint64_t CAL_LMASK[CAL_B + 1];
 extern const uint64_t CAL_RMASK[CAL_B + 1];
 extern const uint64_t CAL_SMASK[CAL_B + 1];
 
+/* Returns the cell a + b + carry and sets carry to the carry out of it.  */
+static inline uint64_t calAdd (uint64_t a, uint64_t b, bool& carry) {
+#if CAL_B == 64
+# ifdef __x86_64__
+  unsigned long long result;
+  carry = _addcarry_u64 (carry, a, b, &result);
+  return result;
+# else
+  unsigned __int128 result = (unsigned __int128) a + b + carry;
+  carry = (uint64_t) (result >> 64) != 0;
+  return (uint64_t) result;
+# endif
+#else
+  uint64_t result = a + b + carry;
+  carry = CAL_CARRY (result);
+  return result & CAL_LMASK[0];
+#endif
+}
+
+/* Returns the cell a - b - borrow and sets borrow to the borrow out of it.  */
+static inline uint64_t calSub (uint64_t a, uint64_t b, bool& borrow) {
+#if CAL_B == 64
+# ifdef __x86_64__
+  unsigned long long result;
+  borrow = _subborrow_u64 (borrow, a, b, &result);
+  return result;
+# else
+  unsigned __int128 result = (unsigned __int128) a - b - borrow;
+  borrow = (uint64_t) (result >> 64) != 0;
+  return (uint64_t) result;
+# endif
+#else
+  uint64_t result = a - b - borrow;
+  borrow = CAL_CARRY (result);
+  return result & CAL_LMASK[0];
+#endif
+}
+
+/* Returns the number of leading zero bits of the cell x, where x > 0.  */
+static inline int calClz (uint64_t x) {
+  return __builtin_clzll (x) - (64 - CAL_B);
+}
+
+/* Returns (high 2^B + low) / d and stores the remainder in rem, where
+   high < d.  */
+static inline uint64_t calDiv (uint64_t high, uint64_t low, uint64_t d, uint64_t& rem) {
+#if CAL_B == 64
+# ifdef __x86_64__
+  uint64_t result;
+  __asm__ ("divq %4" : "=a" (result), "=d" (rem) : "a" (low), "d" (high), "rm" (d));
+  return result;
+# else
+  unsigned __int128 n = (unsigned __int128) high << 64 | low;
+  rem = (uint64_t) (n % d);
+  return (uint64_t) (n / d);
+# endif
+#else
+  uint64_t n = high << CAL_B | low;
+  rem = n % d;
+  return n / d;
+#endif
+}
+
+/* Returns (high 2^B + low) / d and stores the remainder in rem, where
+   high < d, the most significant bit of d is set and inv = calInverse (d).
+   Uses multiplications instead of a division (Moeller and Granlund,
+   Improved division by invariant integers, algorithm 4).  */
+static inline uint64_t calDivPreinv (uint64_t high, uint64_t low, uint64_t d, uint64_t inv, uint64_t& rem) {
+#if CAL_B == 64
+  unsigned __int128 p = (unsigned __int128) inv * high + ((unsigned __int128) high << 64 | low);
+  uint64_t q = (uint64_t) (p >> 64) + 1;
+  uint64_t r = low - q * d;
+  /* The first correction is taken about half of the time, so it is done
+     without a branch.  */
+  const uint64_t mask = - (uint64_t) (r > (uint64_t) p);
+  q += mask;
+  r += mask & d;
+#else
+  /* (2^B + inv) high + low < 2^2B, so p cannot overflow for B <= 32.  */
+  uint64_t p = inv * high + (high << CAL_B | low);
+  uint64_t q = (p >> CAL_B) + 1 & CAL_LMASK[0];
+  uint64_t r = low - q * d & CAL_LMASK[0];
+  const uint64_t mask = - (uint64_t) (r > (p & CAL_LMASK[0]));
+  q = q + mask & CAL_LMASK[0];
+  r = r + (mask & d) & CAL_LMASK[0];
+#endif
+  if (r >= d) {
+    ++q;
+    r -= d;
+  }
+  rem = r;
+  return q;
+}
+
+/* Returns floor ((2^2B - 1) / d) - 2^B, where the most significant bit of d
+   is set, for use with calDivPreinv.  */
+static inline uint64_t calInverse (uint64_t d) {
+  uint64_t rem;
+  return calDiv (~d & CAL_LMASK[0], CAL_LMASK[0], d, rem);
+}
+
+/* Returns the low cell of a * b + c + high and stores its high cell in high.
+   Cannot overflow: (2^B - 1)^2 + 2 (2^B - 1) = 2^2B - 1.  */
+static inline uint64_t calMulAdd (uint64_t a, uint64_t b, uint64_t c, uint64_t& high) {
+#if CAL_B == 64
+  unsigned __int128 result = (unsigned __int128) a * b + c + high;
+  high = (uint64_t) (result >> 64);
+  return (uint64_t) result;
+#else
+  uint64_t result = a * b + c + high;
+  high = result >> CAL_B;
+  return result & CAL_LMASK[0];
+#endif
+}
+
 #endif
@@ -0,0 +1,169 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <atomic>
+#include "cpu.h"
+#include "ifma.h"
+#include "limbs.h"
+
+#ifdef IFMA_SUPPORTED
+
+#include <immintrin.h>
+
+#define MASK52 (((uint64_t) 1 << 52) - 1)
+
+/* Number of cells of 52 bits holding n cells of 64 bits.  */
+#define CELLS52(n) ((64 * (n) + 51) / 52)
+
+/* Room for the cells of 52 bits of an operand of IFMA_MAX_CELLS cells,
+   with the zeros around them that mulColumns reads.  */
+#define BUFFER_SIZE (3 * CELLS52 (IFMA_MAX_CELLS) + 32)
+
+static std::atomic<bool> ifmaActive (Cpu::hasIfma ());
+
+/* dst[0..m) = src[0..n) in cells of 52 bits, where m = CELLS52 (n).  */
+static int toCells52 (uint64_t* dst, const uint64_t* src, const int n) {
+  const int m = CELLS52 (n);
+  for (int k = 0; k < m; ++k) {
+    const int w = 52 * k >> 6;
+    const int s = 52 * k & 63;
+    uint64_t x = src[w] >> s;
+    if (s > 12 && w + 1 < n) {
+      x |= src[w + 1] << 64 - s;
+    }
+    dst[k] = x & MASK52;
+  }
+  return m;
+}
+
+/* Stores the n lower cells of 64 bits of the sum of cols[k] 2^(52 k) for
+   0 <= k < m in dst.  */
+static void fromColumns (uint64_t* dst, const int n, const uint64_t* cols, const int m) {
+  unsigned __int128 bits = 0;
+  int count = 0;
+  uint64_t carry = 0;
+  int k = 0;
+  for (int i = 0; i < n; ++i) {
+    while (count < 64) {
+      const uint64_t x = carry + (k < m ? cols[k] : 0);
+      ++k;
+      carry = x >> 52;
+      bits |= (unsigned __int128) (x & MASK52) << count;
+      count += 52;
+    }
+    dst[i] = (uint64_t) bits;
+    bits >>= 64;
+    count -= 64;
+  }
+}
+
+/* cols[c] = sum of the lower halves of a[c - i] b[i] and the upper halves of
+   a[c - 1 - i] b[i] over 0 <= i < mb, for 0 <= c < columns, where columns
+   is a multiple of 16 and a is preceded by mb + 1 and followed by at least
+   columns - ma zero cells. Two blocks of eight columns are done at once, so
+   that four chains of additions hide the latency of the instructions. Each
+   column is less than 2 mb 2^52, which fits.  */
+__attribute__ ((target ("avx512f,avx512ifma")))
+static void mulColumns (uint64_t* cols, const uint64_t* a, const int columns, const uint64_t* b, const int mb) {
+  for (int c = 0; c < columns; c += 16) {
+    __m512i lo0 = _mm512_setzero_si512 ();
+    __m512i hi0 = _mm512_setzero_si512 ();
+    __m512i lo1 = _mm512_setzero_si512 ();
+    __m512i hi1 = _mm512_setzero_si512 ();
+    for (int i = 0; i < mb; ++i) {
+      const __m512i bi = _mm512_set1_epi64 (b[i]);
+      const uint64_t* x = a + c - i;
+      lo0 = _mm512_madd52lo_epu64 (lo0, _mm512_loadu_si512 (x), bi);
+      hi0 = _mm512_madd52hi_epu64 (hi0, _mm512_loadu_si512 (x - 1), bi);
+      lo1 = _mm512_madd52lo_epu64 (lo1, _mm512_loadu_si512 (x + 8), bi);
+      hi1 = _mm512_madd52hi_epu64 (hi1, _mm512_loadu_si512 (x + 7), bi);
+    }
+    _mm512_storeu_si512 (cols + c, _mm512_add_epi64 (lo0, hi0));
+    _mm512_storeu_si512 (cols + c + 8, _mm512_add_epi64 (lo1, hi1));
+  }
+}
+
+/* dst[0..an+bn) = a * b, where an, bn <= IFMA_MAX_CELLS, as described in
+   ifma.h.  */
+static void mulBlock (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+  uint64_t x[BUFFER_SIZE];
+  uint64_t y[CELLS52 (IFMA_MAX_CELLS)];
+  uint64_t cols[2 * CELLS52 (IFMA_MAX_CELLS) + 16];
+
+  const int mb = b != a || an != bn ? toCells52 (y, b, bn) : CELLS52 (bn);
+  uint64_t* ax = x + mb + 1;
+  const int ma = toCells52 (ax, a, an);
+  const int columns = ma + mb + 15 & ~15;
+  memset (x, 0, mb + 1 << 3);
+  memset (ax + ma, 0, columns - ma + 16 << 3);
+
+  mulColumns (cols, ax, columns, b != a || an != bn ? y : ax, mb);
+  fromColumns (dst, an + bn, cols, ma + mb);
+}
+
+bool Ifma::active (void) {
+  return ifmaActive.load (std::memory_order_relaxed);
+}
+
+/* Multiplies blocks of IFMA_MAX_CELLS cells of a by b and adds the products
+   at their offsets.  */
+void Ifma::mul (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+  int len = an < IFMA_MAX_CELLS ? an : IFMA_MAX_CELLS;
+  mulBlock (dst, a, len, b, bn);
+
+  uint64_t t[2 * IFMA_MAX_CELLS];
+  for (int i = len; i < an; i += len) {
+    len = an - i < IFMA_MAX_CELLS ? an - i : IFMA_MAX_CELLS;
+    mulBlock (t, a + i, len, b, bn);
+    Limbs::add (t, t, len + bn, dst + i, bn);
+    memcpy (dst + i, t, len + bn << 3);
+  }
+}
+
+bool Ifma::setActive (const bool active) {
+  const bool result = active && Cpu::hasIfma ();
+  ifmaActive.store (result, std::memory_order_relaxed);
+  return result;
+}
+
+/* As mul, converting the operand once.  */
+void Ifma::sqr (uint64_t* dst, const uint64_t* a, const int n) {
+  mulBlock (dst, a, n, a, n);
+}
+
+#else
+
+bool Ifma::active (void) {
+  return false;
+}
+
+void Ifma::mul (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+  Limbs::mulBasecase (dst, a, an, b, bn);
+}
+
+bool Ifma::setActive (const bool) {
+  return false;
+}
+
+void Ifma::sqr (uint64_t* dst, const uint64_t* a, const int n) {
+  Limbs::sqrBasecase (dst, a, n);
+}
+
+#endif
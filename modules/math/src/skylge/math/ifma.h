@@ -0,0 +1,66 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__IFMA_INCLUDED
+#define SKYLGE__MATH__IFMA_INCLUDED
+
+#include <stdint.h>
+#include "defs.h"
+
+#if CAL_B == 64 && defined (__x86_64__) && defined (__GNUC__)
+# define IFMA_SUPPORTED
+#endif
+
+/* Operand sizes (in cells) from which Limbs::mulBasecase and
+   Limbs::sqrBasecase use the IFMA kernels below, and the largest operand
+   (the smaller one for mul) they handle.  */
+#ifndef IFMA_MUL_THRESHOLD
+# define IFMA_MUL_THRESHOLD 10
+#endif
+#ifndef IFMA_SQR_THRESHOLD
+# define IFMA_SQR_THRESHOLD 12
+#endif
+#define IFMA_MAX_CELLS 64
+
+/* Multiplication with the AVX-512 IFMA instructions, which multiply eight
+   pairs of 52 bit numbers and add the lower or upper 52 bits of the 104 bit
+   products to eight 64 bit accumulators. The operands are converted to
+   cells of 52 bits, the product is computed by columns, eight at a time,
+   without propagating carries, and the columns are converted back to cells
+   of 64 bits. Only for CAL_B = 64 on x86-64.  */
+namespace Ifma {
+
+  /* Returns true if mul and sqr are to be used: the processor supports
+     IFMA and setActive has not turned them off.  */
+  bool active (void);
+
+  /* dst[0..an+bn) = a * b, where IFMA_MAX_CELLS >= bn > 0 and an > 0. dst
+     may not overlap a or b.  */
+  void mul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* Turns the use of mul and sqr on (if the processor supports IFMA) or
+     off; returns active ().  */
+  bool setActive (bool active);
+
+  /* dst[0..2n) = a^2, where IFMA_MAX_CELLS >= n > 0. dst may not overlap
+     a.  */
+  void sqr (uint64_t* dst, const uint64_t* a, int n);
+}
+
+#endif
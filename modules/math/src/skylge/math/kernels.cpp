@@ -0,0 +1,388 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "cpu.h"
+#include "defs.h"
+#include "kernels.h"
+
+#if CAL_B == 64 && defined (__x86_64__) && defined (__GNUC__)
+# define KERNELS_ASM
+#endif
+
+#ifdef KERNELS_ASM
+
+/* Set before main is entered; until then, the portable versions are used.  */
+static bool useAdx = Cpu::hasAdx () && Cpu::hasBmi2 ();
+
+/* The loops below use an index running from -n up to 0 in rcx, with the
+   pointers moved past the end of the arrays, so that inc or jrcxz ends the
+   loop without disturbing the carries in CF (and OF).  */
+
+static uint64_t addAsm (uint64_t* dst, const uint64_t* a, const uint64_t* b, const int n) {
+  uint64_t i = - (uint64_t) n;
+  uint64_t rest = n & 3;
+  uint64_t quads = n >> 2;
+  uint64_t carry = 0;
+  uint64_t t;
+  __asm__ __volatile__ (
+    "  test %[rest], %[rest]\n"
+    "  clc\n"
+    "  jz 2f\n"
+    "1:\n"
+    "  mov (%[a],%[i],8), %[t]\n"
+    "  adc (%[b],%[i],8), %[t]\n"
+    "  mov %[t], (%[d],%[i],8)\n"
+    "  inc %[i]\n"
+    "  dec %[rest]\n"
+    "  jnz 1b\n"
+    "2:\n"
+    "  jrcxz 4f\n"
+    "3:\n"
+    "  mov (%[a],%[i],8), %[t]\n"
+    "  adc (%[b],%[i],8), %[t]\n"
+    "  mov %[t], (%[d],%[i],8)\n"
+    "  mov 8(%[a],%[i],8), %[t]\n"
+    "  adc 8(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 8(%[d],%[i],8)\n"
+    "  mov 16(%[a],%[i],8), %[t]\n"
+    "  adc 16(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 16(%[d],%[i],8)\n"
+    "  mov 24(%[a],%[i],8), %[t]\n"
+    "  adc 24(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 24(%[d],%[i],8)\n"
+    "  lea 4(%[i]), %[i]\n"
+    "  dec %[quads]\n"
+    "  jnz 3b\n"
+    "4:\n"
+    "  setc %b[carry]\n"
+    : [i] "+c" (i), [rest] "+r" (rest), [quads] "+r" (quads), [carry] "+r" (carry), [t] "=&r" (t)
+    : [d] "r" (dst + n), [a] "r" (a + n), [b] "r" (b + n)
+    : "cc", "memory");
+  return carry;
+}
+
+static uint64_t subAsm (uint64_t* dst, const uint64_t* a, const uint64_t* b, const int n) {
+  uint64_t i = - (uint64_t) n;
+  uint64_t rest = n & 3;
+  uint64_t quads = n >> 2;
+  uint64_t borrow = 0;
+  uint64_t t;
+  __asm__ __volatile__ (
+    "  test %[rest], %[rest]\n"
+    "  clc\n"
+    "  jz 2f\n"
+    "1:\n"
+    "  mov (%[a],%[i],8), %[t]\n"
+    "  sbb (%[b],%[i],8), %[t]\n"
+    "  mov %[t], (%[d],%[i],8)\n"
+    "  inc %[i]\n"
+    "  dec %[rest]\n"
+    "  jnz 1b\n"
+    "2:\n"
+    "  jrcxz 4f\n"
+    "3:\n"
+    "  mov (%[a],%[i],8), %[t]\n"
+    "  sbb (%[b],%[i],8), %[t]\n"
+    "  mov %[t], (%[d],%[i],8)\n"
+    "  mov 8(%[a],%[i],8), %[t]\n"
+    "  sbb 8(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 8(%[d],%[i],8)\n"
+    "  mov 16(%[a],%[i],8), %[t]\n"
+    "  sbb 16(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 16(%[d],%[i],8)\n"
+    "  mov 24(%[a],%[i],8), %[t]\n"
+    "  sbb 24(%[b],%[i],8), %[t]\n"
+    "  mov %[t], 24(%[d],%[i],8)\n"
+    "  lea 4(%[i]), %[i]\n"
+    "  dec %[quads]\n"
+    "  jnz 3b\n"
+    "4:\n"
+    "  setc %b[borrow]\n"
+    : [i] "+c" (i), [rest] "+r" (rest), [quads] "+r" (quads), [borrow] "+r" (borrow), [t] "=&r" (t)
+    : [d] "r" (dst + n), [a] "r" (a + n), [b] "r" (b + n)
+    : "cc", "memory");
+  return borrow;
+}
+
+/* The carry chain of the low halves of the products plus the high halves
+   of the previous ones runs through CF (adcx) and that of adding dst
+   through OF (adox). Two cells are done per iteration, after the first
+   cell if n is odd.  */
+static uint64_t addMul1Adx (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+  uint64_t i = - (uint64_t) n;
+  uint64_t high;
+  uint64_t low;
+  uint64_t next;
+  __asm__ __volatile__ (
+    "  xor %k[high], %k[high]\n"
+    "  test $1, %b[i]\n"
+    "  jz 1f\n"
+    "  mulx (%[s],%[i],8), %[low], %[high]\n"
+    "  add %[low], (%[d],%[i],8)\n"
+    "  adc $0, %[high]\n"
+    "  lea 1(%[i]), %[i]\n"
+    "  test %[i], %[i]\n"
+    "  jz 2f\n"
+    "  xor %k[low], %k[low]\n"
+    "1:\n"
+    "  mulx (%[s],%[i],8), %[low], %[next]\n"
+    "  adcx %[high], %[low]\n"
+    "  adox (%[d],%[i],8), %[low]\n"
+    "  mov %[low], (%[d],%[i],8)\n"
+    "  mulx 8(%[s],%[i],8), %[low], %[high]\n"
+    "  adcx %[next], %[low]\n"
+    "  adox 8(%[d],%[i],8), %[low]\n"
+    "  mov %[low], 8(%[d],%[i],8)\n"
+    "  lea 2(%[i]), %[i]\n"
+    "  jrcxz 3f\n"
+    "  jmp 1b\n"
+    "3:\n"
+    "  mov $0, %k[low]\n"
+    "  adcx %[low], %[high]\n"
+    "  adox %[low], %[high]\n"
+    "2:\n"
+    : [i] "+c" (i), [high] "=&r" (high), [low] "=&r" (low), [next] "=&r" (next)
+    : [d] "r" (dst + n), [s] "r" (src + n), "d" (m)
+    : "cc", "memory");
+  return high;
+}
+
+static uint64_t mul1Adx (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+  uint64_t i = - (uint64_t) n;
+  uint64_t high;
+  uint64_t low;
+  uint64_t next;
+  __asm__ __volatile__ (
+    "  xor %k[high], %k[high]\n"
+    "1:\n"
+    "  mulx (%[s],%[i],8), %[low], %[next]\n"
+    "  adcx %[high], %[low]\n"
+    "  mov %[low], (%[d],%[i],8)\n"
+    "  mov %[next], %[high]\n"
+    "  inc %[i]\n"
+    "  jnz 1b\n"
+    "  adc $0, %[high]\n"
+    : [i] "+c" (i), [high] "=&r" (high), [low] "=&r" (low), [next] "=&r" (next)
+    : [d] "r" (dst + n), [s] "r" (src + n), "d" (m)
+    : "cc", "memory");
+  return high;
+}
+
+static uint64_t shlAdx (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+  uint64_t i = n - 1;
+  uint64_t k = 64 - bits;
+  uint64_t result;
+  uint64_t x;
+  uint64_t y;
+  uint64_t t;
+  __asm__ __volatile__ (
+    "  mov (%[s],%[i],8), %[x]\n"
+    "  shrx %[k], %[x], %[result]\n"
+    "  test %[i], %[i]\n"
+    "  jz 2f\n"
+    "1:\n"
+    "  mov -8(%[s],%[i],8), %[y]\n"
+    "  shlx %[bits], %[x], %[x]\n"
+    "  shrx %[k], %[y], %[t]\n"
+    "  or %[t], %[x]\n"
+    "  mov %[x], (%[d],%[i],8)\n"
+    "  mov %[y], %[x]\n"
+    "  dec %[i]\n"
+    "  jnz 1b\n"
+    "2:\n"
+    "  shlx %[bits], %[x], %[x]\n"
+    "  mov %[x], (%[d])\n"
+    : [i] "+r" (i), [result] "=&r" (result), [x] "=&r" (x), [y] "=&r" (y), [t] "=&r" (t)
+    : [d] "r" (dst), [s] "r" (src), [bits] "r" ((uint64_t) bits), [k] "r" (k)
+    : "cc", "memory");
+  return result;
+}
+
+static void shrAdx (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+  uint64_t i = 0;
+  uint64_t count = n - 1;
+  uint64_t k = 64 - bits;
+  uint64_t x;
+  uint64_t y;
+  uint64_t t;
+  __asm__ __volatile__ (
+    "  mov (%[s]), %[x]\n"
+    "  test %[count], %[count]\n"
+    "  jz 2f\n"
+    "1:\n"
+    "  mov 8(%[s],%[i],8), %[y]\n"
+    "  shrx %[bits], %[x], %[x]\n"
+    "  shlx %[k], %[y], %[t]\n"
+    "  or %[t], %[x]\n"
+    "  mov %[x], (%[d],%[i],8)\n"
+    "  mov %[y], %[x]\n"
+    "  inc %[i]\n"
+    "  dec %[count]\n"
+    "  jnz 1b\n"
+    "2:\n"
+    "  shrx %[bits], %[x], %[x]\n"
+    "  mov %[x], (%[d],%[i],8)\n"
+    : [i] "+r" (i), [count] "+r" (count), [x] "=&r" (x), [y] "=&r" (y), [t] "=&r" (t)
+    : [d] "r" (dst), [s] "r" (src), [bits] "r" ((uint64_t) bits), [k] "r" (k)
+    : "cc", "memory");
+}
+
+/* Each product, plus the high half carried in, is subtracted from dst;
+   the carry of the addition and the borrow of the subtraction both go
+   into the high half, which cannot overflow.  */
+static uint64_t subMul1Adx (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+  uint64_t i = - (uint64_t) n;
+  uint64_t high;
+  uint64_t low;
+  uint64_t next;
+  uint64_t t;
+  __asm__ __volatile__ (
+    "  xor %k[high], %k[high]\n"
+    "1:\n"
+    "  mulx (%[s],%[i],8), %[low], %[next]\n"
+    "  add %[high], %[low]\n"
+    "  adc $0, %[next]\n"
+    "  mov (%[d],%[i],8), %[t]\n"
+    "  sub %[low], %[t]\n"
+    "  adc $0, %[next]\n"
+    "  mov %[t], (%[d],%[i],8)\n"
+    "  mov %[next], %[high]\n"
+    "  inc %[i]\n"
+    "  jnz 1b\n"
+    : [i] "+c" (i), [high] "=&r" (high), [low] "=&r" (low), [next] "=&r" (next), [t] "=&r" (t)
+    : [d] "r" (dst + n), [s] "r" (src + n), "d" (m)
+    : "cc", "memory");
+  return high;
+}
+
+#endif
+
+uint64_t Kernels::add (uint64_t* dst, const uint64_t* a, const uint64_t* b, const int n) {
+#ifdef KERNELS_ASM
+  if (n > 0)
+    return addAsm (dst, a, b, n);
+  return 0;
+#else
+  bool carry = false;
+  for (int i = 0; i < n; ++i) {
+    dst[i] = calAdd (a[i], b[i], carry);
+  }
+  return carry;
+#endif
+}
+
+uint64_t Kernels::addMul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef KERNELS_ASM
+  if (useAdx && n > 0)
+    return addMul1Adx (dst, src, n, m);
+#endif
+  bool carry = false;
+  uint64_t high = 0;
+  for (int i = 0; i < n; ++i) {
+    uint64_t low = calMulAdd (src[i], m, 0, high);
+    dst[i] = calAdd (dst[i], low, carry);
+  }
+  return high + carry;
+}
+
+bool Kernels::adx (void) {
+#ifdef KERNELS_ASM
+  return useAdx;
+#else
+  return false;
+#endif
+}
+
+uint64_t Kernels::mul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef KERNELS_ASM
+  if (useAdx && n > 0)
+    return mul1Adx (dst, src, n, m);
+#endif
+  uint64_t high = 0;
+  for (int i = 0; i < n; ++i) {
+    dst[i] = calMulAdd (src[i], m, 0, high);
+  }
+  return high;
+}
+
+bool Kernels::setAdx (const bool enabled) {
+#ifdef KERNELS_ASM
+  useAdx = enabled && Cpu::hasAdx () && Cpu::hasBmi2 ();
+  return useAdx;
+#else
+  (void) enabled;
+  return false;
+#endif
+}
+
+uint64_t Kernels::shl (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+#ifdef KERNELS_ASM
+  if (useAdx)
+    return shlAdx (dst, src, n, bits);
+#endif
+  const int k = CAL_B - bits;
+  const uint64_t result = src[n - 1] >> k;
+  for (int i = n - 1; i > 0; --i) {
+    dst[i] = (src[i] << bits | src[i - 1] >> k) & CAL_LMASK[0];
+  }
+  dst[0] = src[0] << bits & CAL_LMASK[0];
+  return result;
+}
+
+void Kernels::shr (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+#ifdef KERNELS_ASM
+  if (useAdx) {
+    shrAdx (dst, src, n, bits);
+    return;
+  }
+#endif
+  const int k = CAL_B - bits;
+  for (int i = 0; i < n - 1; ++i) {
+    dst[i] = (src[i] >> bits | src[i + 1] << k) & CAL_LMASK[0];
+  }
+  dst[n - 1] = src[n - 1] >> bits;
+}
+
+uint64_t Kernels::sub (uint64_t* dst, const uint64_t* a, const uint64_t* b, const int n) {
+#ifdef KERNELS_ASM
+  if (n > 0)
+    return subAsm (dst, a, b, n);
+  return 0;
+#else
+  bool borrow = false;
+  for (int i = 0; i < n; ++i) {
+    dst[i] = calSub (a[i], b[i], borrow);
+  }
+  return borrow;
+#endif
+}
+
+uint64_t Kernels::subMul1 (uint64_t* dst, const uint64_t* src, const int n, const uint64_t m) {
+#ifdef KERNELS_ASM
+  if (useAdx && n > 0)
+    return subMul1Adx (dst, src, n, m);
+#endif
+  bool borrow = false;
+  uint64_t high = 0;
+  for (int i = 0; i < n; ++i) {
+    uint64_t low = calMulAdd (src[i], m, 0, high);
+    dst[i] = calSub (dst[i], low, borrow);
+  }
+  return high + borrow;
+}
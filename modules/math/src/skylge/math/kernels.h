@@ -0,0 +1,70 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__KERNELS_INCLUDED
+#define SKYLGE__MATH__KERNELS_INCLUDED
+
+#include <stdint.h>
+
+/* The innermost loops over arrays of cells, on which Limbs and Integer are
+   built. For CAL_B = 64 on x86-64 they are written in assembly, in a
+   version using the ADX and BMI2 instructions (adcx, adox, mulx, shlx,
+   shrx) where the processor has them, which is checked once through CPUID
+   when the program starts; otherwise, and for the other values of CAL_B,
+   portable versions are used. Lengths may be 0 unless stated otherwise.  */
+namespace Kernels {
+
+  /* dst = a + b, where all have n cells; returns the carry. dst may be a or
+     b.  */
+  uint64_t add (uint64_t* dst, const uint64_t* a, const uint64_t* b, int n);
+
+  /* dst += src * m, where both have n cells and m < 2^CAL_B; returns the
+     cell carried out of dst[n - 1].  */
+  uint64_t addMul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+
+  /* Returns true if the versions using ADX and BMI2 are in use.  */
+  bool adx (void);
+
+  /* dst = src * m, where m < 2^CAL_B; returns the cell carried out. dst may
+     be src.  */
+  uint64_t mul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+
+  /* Turns the versions using ADX and BMI2 on (if the processor has them) or
+     off, e.g. to test both; returns adx (). Not to be called while other
+     threads use the kernels.  */
+  bool setAdx (bool enabled);
+
+  /* dst = src << bits, where n > 0 and 0 < bits < CAL_B; returns the bits
+     shifted out of src[n - 1]. dst may be src or any address above it.  */
+  uint64_t shl (uint64_t* dst, const uint64_t* src, int n, int bits);
+
+  /* dst = src >> bits, where n > 0 and 0 < bits < CAL_B. dst may be src or
+     any address below it.  */
+  void shr (uint64_t* dst, const uint64_t* src, int n, int bits);
+
+  /* dst = a - b, where all have n cells; returns the borrow. dst may be a
+     or b.  */
+  uint64_t sub (uint64_t* dst, const uint64_t* a, const uint64_t* b, int n);
+
+  /* dst -= src * m, where both have n cells and m < 2^CAL_B; returns the
+     cell borrowed out of dst[n - 1].  */
+  uint64_t subMul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+}
+
+#endif
@@ -0,0 +1,781 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include "defs.h"
+#include "ifma.h"
+#include "kernels.h"
+#include "limbs.h"
+
+static int correctQuotient (uint64_t* q, int k, int qh, uint64_t* n, const uint64_t* d, int dn, uint64_t* scratch);
+static int divRecursive (uint64_t* q, uint64_t* n, const uint64_t* d, int dn, uint64_t* scratch);
+static void mulKaratsuba (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* scratch);
+static void mulToom3 (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* scratch);
+static void mulToom4 (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* scratch);
+static void mulUnbalanced (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* scratch);
+static void sqrKaratsuba (uint64_t* dst, const uint64_t* a, int n, uint64_t* scratch);
+static void sqrToom3 (uint64_t* dst, const uint64_t* a, int n, uint64_t* scratch);
+static void sqrToom4 (uint64_t* dst, const uint64_t* a, int n, uint64_t* scratch);
+
+bool Limbs::add (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn) {
+  int i = bn;
+  bool carry = Kernels::add (dst, a, b, bn) != 0;
+  while (carry && i < an) {
+    dst[i] = calAdd (a[i], 0, carry);
+    ++i;
+  }
+  if (dst != a) {
+    while (i < an) {
+      dst[i] = a[i];
+      ++i;
+    }
+  }
+  return carry;
+}
+
+uint64_t Limbs::addMul1 (uint64_t* dst, int dn, const uint64_t* src, int sn, uint64_t m) {
+  int i = sn;
+  uint64_t high = Kernels::addMul1 (dst, src, sn, m);
+  while (high > 0 && i < dn) {
+    bool carry = false;
+    dst[i] = calAdd (dst[i], high, carry);
+    high = carry;
+    ++i;
+  }
+  return high;
+}
+
+int Limbs::cmp (const uint64_t* a, const uint64_t* b, int n) {
+  int i = n - 1;
+  while (i > -1 && a[i] == b[i]) {
+    --i;
+  }
+  if (i == -1)
+    return 0;
+  return a[i] < b[i] ? -1 : 1;
+}
+
+/* The quotient is produced in blocks of dn cells by divRecursive, starting
+   with the most significant block, which takes the remaining qn mod dn
+   cells.  */
+void Limbs::div (uint64_t* q, uint64_t* n, const int nn, const uint64_t* d, const int dn, uint64_t* scratch) {
+  const int qn = nn - dn + 1;
+  if (dn < DIV_DC_THRESHOLD || qn < DIV_DC_THRESHOLD) {
+    divBasecase (q, n, nn, d, dn);
+    return;
+  }
+
+  const int k = (qn - 1) % dn + 1;
+  int pos = qn - k;
+  if (k == dn) {
+    divRecursive (q + pos, n + pos, d, dn, scratch);
+  } else if (k < DIV_DC_THRESHOLD) {
+    divBasecase (q + pos, n + pos, dn + k - 1, d, dn);
+  } else {
+    int qh = divRecursive (q + pos, n + pos + dn - k, d + dn - k, k, scratch);
+    correctQuotient (q + pos, k, qh, n + pos, d, dn, scratch);
+  }
+  while (pos > 0) {
+    pos -= dn;
+    divRecursive (q + pos, n + pos, d, dn, scratch);
+  }
+}
+
+/* Each quotient cell is first estimated from the two most significant cells
+   of the partial remainder and the most significant cell of d, then corrected
+   using the next cell of d; the estimate is then at most one too large, which
+   shows as a borrow when q d is subtracted.  */
+void Limbs::divBasecase (uint64_t* q, uint64_t* n, const int nn, const uint64_t* d, const int dn) {
+  const uint64_t dtop = d[dn - 1];
+  const uint64_t dnext = d[dn - 2];
+  for (int j = nn - dn; j > -1; --j) {
+    uint64_t* r = n + j;
+    uint64_t qhat;
+    uint64_t rhat;
+    bool rhatOverflow = false;
+    if (r[dn] == dtop) {
+      qhat = CAL_LMASK[0];
+      rhat = calAdd (r[dn - 1], dtop, rhatOverflow);
+    } else {
+      qhat = calDiv (r[dn], r[dn - 1], dtop, rhat);
+    }
+    while (!rhatOverflow) {
+      uint64_t high = 0;
+      uint64_t low = calMulAdd (qhat, dnext, 0, high);
+      if (high < rhat || high == rhat && low <= r[dn - 2])
+        break;
+      --qhat;
+      rhat = calAdd (rhat, dtop, rhatOverflow);
+    }
+    if (subMul1 (r, dn + 1, d, dn, qhat) != 0) {
+      --qhat;
+      add (r, r, dn + 1, d, dn);
+    }
+    q[j] = qhat;
+  }
+}
+
+/* Computes q = (src - carry) / d one cell at a time modulo 2^CAL_B, using the
+   inverse of d; the carry into the next cell is the part of d q that does not
+   fit in a cell.  */
+void Limbs::divExact (uint64_t* dst, const uint64_t* src, int n, uint64_t d) {
+  uint64_t inverse = d; /* Correct in the lowest 3 bits, since d is odd.  */
+  for (int i = 0; i < 5; ++i) {
+    inverse *= 2 - d * inverse;
+  }
+  inverse &= CAL_LMASK[0];
+
+  uint64_t carry = 0;
+  for (int i = 0; i < n; ++i) {
+    bool borrow = false;
+    uint64_t q = calSub (src[i], carry, borrow) * inverse & CAL_LMASK[0];
+    dst[i] = q;
+    carry = 0;
+    calMulAdd (q, d, 0, carry);
+    carry += borrow;
+  }
+}
+
+uint64_t Limbs::divRem1 (uint64_t* q, const uint64_t* src, const int n, const uint64_t d) {
+  const int shift = calClz (d);
+  return divRem1Preinv (q, src, n, d << shift, shift, calInverse (d << shift));
+}
+
+/* The cells of src are shifted left on the fly, as src[i] is read before
+   q[i] is written.  */
+uint64_t Limbs::divRem1Preinv (uint64_t* q, const uint64_t* src, const int n, const uint64_t d, const int shift, const uint64_t inv) {
+  uint64_t rem = 0;
+  if (shift == 0) {
+    for (int i = n - 1; i > -1; --i) {
+      q[i] = calDivPreinv (rem, src[i], d, inv, rem);
+    }
+    return rem;
+  }
+
+  uint64_t high = src[n - 1];
+  rem = high >> CAL_B - shift;
+  for (int i = n - 2; i > -1; --i) {
+    const uint64_t low = src[i];
+    q[i + 1] = calDivPreinv (rem, (high << shift | low >> CAL_B - shift) & CAL_LMASK[0], d, inv, rem);
+    high = low;
+  }
+  q[0] = calDivPreinv (rem, high << shift & CAL_LMASK[0], d, inv, rem);
+  return rem >> shift;
+}
+
+uint64_t Limbs::mod1Preinv (const uint64_t* src, const int n, const uint64_t d, const int shift, const uint64_t inv) {
+  uint64_t rem = 0;
+  if (shift == 0) {
+    for (int i = n - 1; i > -1; --i) {
+      calDivPreinv (rem, src[i], d, inv, rem);
+    }
+    return rem;
+  }
+
+  uint64_t high = src[n - 1];
+  rem = high >> CAL_B - shift;
+  for (int i = n - 2; i > -1; --i) {
+    const uint64_t low = src[i];
+    calDivPreinv (rem, (high << shift | low >> CAL_B - shift) & CAL_LMASK[0], d, inv, rem);
+    high = low;
+  }
+  calDivPreinv (rem, high << shift & CAL_LMASK[0], d, inv, rem);
+  return rem >> shift;
+}
+
+void Limbs::mul (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn, uint64_t* scratch) {
+  if (bn < KARATSUBA_THRESHOLD) {
+    mulBasecase (dst, a, an, b, bn);
+  } else if (bn < TOOM3_THRESHOLD) {
+    if (bn > an + 1 >> 1)
+      mulKaratsuba (dst, a, an, b, bn, scratch);
+    else
+      mulUnbalanced (dst, a, an, b, bn, scratch);
+  } else if (bn < TOOM4_THRESHOLD) {
+    if (bn > 2 * ((an + 2) / 3))
+      mulToom3 (dst, a, an, b, bn, scratch);
+    else
+      mulUnbalanced (dst, a, an, b, bn, scratch);
+  } else {
+    if (bn > 3 * (an + 3 >> 2))
+      mulToom4 (dst, a, an, b, bn, scratch);
+    else
+      mulUnbalanced (dst, a, an, b, bn, scratch);
+  }
+}
+
+uint64_t Limbs::mul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m) {
+  return Kernels::mul1 (dst, src, n, m);
+}
+
+void Limbs::mulBasecase (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn) {
+#ifdef IFMA_SUPPORTED
+  if (an >= IFMA_MUL_THRESHOLD && bn >= IFMA_MUL_THRESHOLD && (an <= IFMA_MAX_CELLS || bn <= IFMA_MAX_CELLS) && Ifma::active ()) {
+    if (bn <= IFMA_MAX_CELLS)
+      Ifma::mul (dst, a, an, b, bn);
+    else
+      Ifma::mul (dst, b, bn, a, an);
+    return;
+  }
+#endif
+
+  dst[an] = Kernels::mul1 (dst, a, an, b[0]);
+  for (int i = 1; i < bn; ++i) {
+    dst[i + an] = b[i] > 0 ? Kernels::addMul1 (dst + i, a, an, b[i]) : 0;
+  }
+}
+
+/* divRecursive needs dn cells for a product plus the scratch of the
+   multiplication at each level, but no more than that across levels.  */
+int Limbs::divScratchSize (int n) {
+  return n + mulScratchSize (n);
+}
+
+/* Toom-4 needs the most scratch per level: 18 (k + 1) cells with k about
+   n / 4; the bound below also covers the unbalanced case, squaring and the
+   additional cells needed at each level of recursion.  */
+int Limbs::mulScratchSize (int n) {
+  int result = 0;
+  if (n >= KARATSUBA_THRESHOLD || n >= SQR_KARATSUBA_THRESHOLD) {
+    result = 10 * n;
+    while (n > 0) {
+      result += 64;
+      n >>= 1;
+    }
+  }
+  return result;
+}
+
+uint64_t Limbs::shl (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+  return Kernels::shl (dst, src, n, bits);
+}
+
+void Limbs::shr (uint64_t* dst, const uint64_t* src, const int n, const int bits) {
+  Kernels::shr (dst, src, n, bits);
+}
+
+void Limbs::sqr (uint64_t* dst, const uint64_t* a, const int n, uint64_t* scratch) {
+  if (n < SQR_KARATSUBA_THRESHOLD)
+    sqrBasecase (dst, a, n);
+  else if (n < SQR_TOOM3_THRESHOLD)
+    sqrKaratsuba (dst, a, n, scratch);
+  else if (n < SQR_TOOM4_THRESHOLD)
+    sqrToom3 (dst, a, n, scratch);
+  else
+    sqrToom4 (dst, a, n, scratch);
+}
+
+/* Adds each product a[i] a[j] with i < j once, doubles the sum and then adds
+   the squares a[i]^2.  */
+void Limbs::sqrBasecase (uint64_t* dst, const uint64_t* a, const int n) {
+#ifdef IFMA_SUPPORTED
+  if (n >= IFMA_SQR_THRESHOLD && n <= IFMA_MAX_CELLS && Ifma::active ()) {
+    Ifma::sqr (dst, a, n);
+    return;
+  }
+#endif
+
+  dst[0] = 0;
+  dst[n] = mul1 (dst + 1, a + 1, n - 1, a[0]);
+  for (int i = 1; i < n - 1; ++i) {
+    dst[n + i] = addMul1 (dst + 2 * i + 1, n - i - 1, a + i + 1, n - i - 1, a[i]);
+  }
+  dst[2 * n - 1] = 0;
+  add (dst, dst, 2 * n, dst, 2 * n);
+
+  bool carry = false;
+  for (int i = 0; i < n; ++i) {
+    uint64_t high = 0;
+    uint64_t low = calMulAdd (a[i], a[i], 0, high);
+    dst[2 * i] = calAdd (dst[2 * i], low, carry);
+    dst[2 * i + 1] = calAdd (dst[2 * i + 1], high, carry);
+  }
+}
+
+bool Limbs::sub (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn) {
+  int i = bn;
+  bool borrow = Kernels::sub (dst, a, b, bn) != 0;
+  while (borrow && i < an) {
+    dst[i] = calSub (a[i], 0, borrow);
+    ++i;
+  }
+  if (dst != a) {
+    while (i < an) {
+      dst[i] = a[i];
+      ++i;
+    }
+  }
+  return borrow;
+}
+
+bool Limbs::subAbs (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn) {
+  int i = an - 1;
+  while (i >= bn && a[i] == 0) {
+    --i;
+  }
+  if (i >= bn || cmp (a, b, bn) >= 0) {
+    sub (dst, a, an, b, bn);
+    return false;
+  }
+  sub (dst, b, bn, a, bn);
+  memset (dst + bn, 0, an - bn << 3);
+  return true;
+}
+
+uint64_t Limbs::subMul1 (uint64_t* dst, int dn, const uint64_t* src, int sn, uint64_t m) {
+  int i = sn;
+  uint64_t high = Kernels::subMul1 (dst, src, sn, m);
+  while (high > 0 && i < dn) {
+    bool borrow = false;
+    dst[i] = calSub (dst[i], high, borrow);
+    high = borrow;
+    ++i;
+  }
+  return high;
+}
+
+/* Adds the coefficient src of length len at dst + offset, where dst holds n
+   cells. Coefficients are non-negative and the product fits in dst, so the
+   cells of src beyond the end of dst are zero.  */
+static void addCoefficient (uint64_t* dst, int n, int offset, const uint64_t* src, int len) {
+  const int rest = n - offset;
+  Limbs::add (dst + offset, dst + offset, rest, src, len < rest ? len : rest);
+}
+
+/* Completes the division of n[0..dn) by d[0..dn), after the top cells of n
+   have been divided by the top k cells of d, giving quotient qh B^k + q with
+   q of k cells and the remainder in place. Subtracts q times the low dn - k
+   cells of d from n and then corrects q, which is at most two too large.
+   Returns the corrected qh.  */
+static int correctQuotient (uint64_t* q, const int k, int qh, uint64_t* n, const uint64_t* d, const int dn, uint64_t* scratch) {
+  static const uint64_t one = 1;
+  const int m = dn - k;
+  uint64_t* t = scratch;
+  scratch += dn;
+
+  if (k >= m)
+    Limbs::mul (t, q, k, d, m, scratch);
+  else
+    Limbs::mul (t, d, m, q, k, scratch);
+  int borrow = Limbs::sub (n, n, dn, t, dn);
+  if (qh != 0) {
+    borrow += Limbs::sub (n + k, n + k, m, d, m);
+  }
+  while (borrow > 0) {
+    qh -= Limbs::sub (q, q, k, &one, 1);
+    borrow -= Limbs::add (n, n, dn, d, dn);
+  }
+  return qh;
+}
+
+/* Divides n[0..2dn) by d[0..dn), with the most significant bit of d set
+   (Burnikel and Ziegler): the upper half of the quotient is obtained by
+   dividing the top cells of n by the upper half of d recursively and then
+   corrected, after which the same is done for the lower half. Stores the
+   quotient in qh B^dn + q[0..dn) and returns qh; leaves the remainder in
+   n[0..dn).  */
+static int divRecursive (uint64_t* q, uint64_t* n, const uint64_t* d, const int dn, uint64_t* scratch) {
+  int qh;
+  if (dn < DIV_DC_THRESHOLD) {
+    qh = Limbs::cmp (n + dn, d, dn) >= 0;
+    if (qh != 0) {
+      Limbs::sub (n + dn, n + dn, dn, d, dn);
+    }
+    Limbs::divBasecase (q, n, 2 * dn - 1, d, dn);
+  } else {
+    const int lo = dn >> 1;
+    const int hi = dn - lo;
+    qh = divRecursive (q + lo, n + 2 * lo, d + lo, hi, scratch);
+    qh = correctQuotient (q + lo, hi, qh, n + lo, d, dn, scratch);
+    int ql = divRecursive (q, n + hi, d + hi, lo, scratch);
+    correctQuotient (q, lo, ql, n, d, dn, scratch);
+  }
+  return qh;
+}
+
+/* Interpolation of Toom-3 from the values v(0) and v(inf), stored in dst and
+   dst + 4k, v(1), v(-1) and v(2), each of length 2k + 2; v(-1) is negative if
+   vm1Sign is set. The coefficients are added into dst, which holds n cells.
+   v1, vm1 and v2 are overwritten.  */
+static void interpolateToom3 (uint64_t* dst, const int n, const int k, const int infLen, uint64_t* v1, uint64_t* vm1, const bool vm1Sign, uint64_t* v2) {
+  const int len = 2 * k + 2;
+  uint64_t* const v0 = dst;
+  uint64_t* const vInf = dst + 4 * k;
+
+  /* With c(x) = c0 + c1 x + ... + c4 x^4 the product polynomial.  */
+  if (vm1Sign) {
+    Limbs::add (v2, v2, len, vm1, len);
+    Limbs::add (vm1, v1, len, vm1, len);
+  } else {
+    Limbs::sub (v2, v2, len, vm1, len);
+    Limbs::sub (vm1, v1, len, vm1, len);
+  }
+  Limbs::divExact (v2, v2, len, 3);     /* c1 + c2 + 3 c3 + 5 c4  */
+  Limbs::shr (vm1, vm1, len, 1);        /* c1 + c3  */
+  Limbs::sub (v1, v1, len, v0, 2 * k);  /* c1 + c2 + c3 + c4  */
+  Limbs::sub (v2, v2, len, v1, len);
+  Limbs::shr (v2, v2, len, 1);
+  Limbs::subMul1 (v2, len, vInf, infLen, 2);   /* c3  */
+  Limbs::sub (v1, v1, len, vm1, len);
+  Limbs::sub (v1, v1, len, vInf, infLen);      /* c2  */
+  Limbs::sub (vm1, vm1, len, v2, len);         /* c1  */
+
+  memset (dst + 2 * k, 0, 2 * k << 3);
+  addCoefficient (dst, n, k, vm1, len);
+  addCoefficient (dst, n, 2 * k, v1, len);
+  addCoefficient (dst, n, 3 * k, v2, len);
+}
+
+/* Interpolation of Toom-4 from the values v(0) and v(inf), stored in dst and
+   dst + 6k, and v(1), v(-1), v(2), v(-2) and 64 v(1/2) (vh), each of length
+   2k + 2; v(-1) and v(-2) are negative if vm1Sign and vm2Sign are set. The
+   coefficients are added into dst, which holds n cells. t must hold 2k + 2
+   cells; v1 to vh are overwritten.  */
+static void interpolateToom4 (uint64_t* dst, const int n, const int k, const int infLen, uint64_t* v1, uint64_t* vm1, const bool vm1Sign, uint64_t* v2, uint64_t* vm2, const bool vm2Sign, uint64_t* vh, uint64_t* t) {
+  const int len = 2 * k + 2;
+  uint64_t* const v0 = dst;
+  uint64_t* const vInf = dst + 6 * k;
+
+  /* With c(x) = c0 + c1 x + ... + c6 x^6 the product polynomial.  */
+  if (vm1Sign) {
+    Limbs::sub (t, v1, len, vm1, len);
+    Limbs::add (vm1, v1, len, vm1, len);
+  } else {
+    Limbs::add (t, v1, len, vm1, len);
+    Limbs::sub (vm1, v1, len, vm1, len);
+  }
+  Limbs::shr (t, t, len, 1);        /* c0 + c2 + c4 + c6  */
+  Limbs::shr (vm1, vm1, len, 1);    /* c1 + c3 + c5  */
+  if (vm2Sign) {
+    Limbs::sub (v1, v2, len, vm2, len);
+    Limbs::add (vm2, v2, len, vm2, len);
+  } else {
+    Limbs::add (v1, v2, len, vm2, len);
+    Limbs::sub (vm2, v2, len, vm2, len);
+  }
+  Limbs::shr (v1, v1, len, 1);      /* c0 + 4 c2 + 16 c4 + 64 c6  */
+  Limbs::shr (vm2, vm2, len, 2);    /* c1 + 4 c3 + 16 c5  */
+
+  Limbs::sub (t, t, len, v0, 2 * k);
+  Limbs::sub (t, t, len, vInf, infLen);        /* c2 + c4  */
+  Limbs::sub (v1, v1, len, v0, 2 * k);
+  Limbs::shr (v1, v1, len, 2);
+  Limbs::subMul1 (v1, len, vInf, infLen, 16);  /* c2 + 4 c4  */
+  Limbs::sub (v1, v1, len, t, len);
+  Limbs::divExact (v1, v1, len, 3);            /* c4  */
+  Limbs::sub (t, t, len, v1, len);             /* c2  */
+
+  Limbs::sub (vh, vh, len, vInf, infLen);
+  Limbs::shr (vh, vh, len, 1);
+  Limbs::subMul1 (vh, len, v0, 2 * k, 32);
+  Limbs::subMul1 (vh, len, t, len, 8);
+  Limbs::subMul1 (vh, len, v1, len, 2);        /* 16 c1 + 4 c3 + c5  */
+
+  Limbs::sub (vm2, vm2, len, vm1, len);
+  Limbs::divExact (vm2, vm2, len, 3);          /* c3 + 5 c5  */
+  Limbs::sub (vh, vh, len, vm1, len);
+  Limbs::divExact (vh, vh, len, 3);            /* 5 c1 + c3  */
+  Limbs::mul1 (v2, vm1, len, 5);
+  Limbs::sub (v2, v2, len, vm2, len);
+  Limbs::sub (v2, v2, len, vh, len);
+  Limbs::divExact (v2, v2, len, 3);            /* c3  */
+  Limbs::sub (vm2, vm2, len, v2, len);
+  Limbs::divExact (vm2, vm2, len, 5);          /* c5  */
+  Limbs::sub (vh, vh, len, v2, len);
+  Limbs::divExact (vh, vh, len, 5);            /* c1  */
+
+  memset (dst + 2 * k, 0, 4 * k << 3);
+  addCoefficient (dst, n, k, vh, len);
+  addCoefficient (dst, n, 2 * k, t, len);
+  addCoefficient (dst, n, 3 * k, v2, len);
+  addCoefficient (dst, n, 4 * k, v1, len);
+  addCoefficient (dst, n, 5 * k, vm2, len);
+}
+
+/* Requires an >= bn > ceil (an / 2). With a = a1 B^m + a0 and b = b1 B^m + b0:
+   a b = a1 b1 B^2m + ((a0 + a1) (b0 + b1) - a0 b0 - a1 b1) B^m + a0 b0.  */
+static void mulKaratsuba (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn, uint64_t* scratch) {
+  const int m = an + 1 >> 1;
+  const int ah = an - m;
+  const int bh = bn - m;
+  uint64_t* sa = scratch;
+  uint64_t* sb = sa + m + 1;
+  uint64_t* mid = sb + m + 1;
+  scratch = mid + 2 * m + 2;
+
+  sa[m] = Limbs::add (sa, a, m, a + m, ah);
+  sb[m] = Limbs::add (sb, b, m, b + m, bh);
+  Limbs::mul (dst, a, m, b, m, scratch);
+  if (ah >= bh)
+    Limbs::mul (dst + 2 * m, a + m, ah, b + m, bh, scratch);
+  else
+    Limbs::mul (dst + 2 * m, b + m, bh, a + m, ah, scratch);
+  Limbs::mul (mid, sa, m + 1, sb, m + 1, scratch);
+
+  Limbs::sub (mid, mid, 2 * m + 2, dst, 2 * m);
+  Limbs::sub (mid, mid, 2 * m + 2, dst + 2 * m, ah + bh);
+  addCoefficient (dst, an + bn, m, mid, 2 * m + 2);
+}
+
+/* Requires an >= bn > 2 ceil (an / 3). Evaluates a and b, split into three
+   pieces of k cells, at 0, 1, -1, 2 and infinity and interpolates the five
+   products with the sequence of Bodrato and Zanoni.  */
+static void mulToom3 (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn, uint64_t* scratch) {
+  const int k = (an + 2) / 3;
+  const int ah = an - 2 * k;
+  const int bh = bn - 2 * k;
+  const int len = 2 * k + 2;
+  uint64_t* ta = scratch;
+  uint64_t* tb = ta + k + 1;
+  uint64_t* ea = tb + k + 1;
+  uint64_t* eb = ea + k + 1;
+  uint64_t* v1 = eb + k + 1;
+  uint64_t* vm1 = v1 + len;
+  uint64_t* v2 = vm1 + len;
+  scratch = v2 + len;
+
+  /* a0 + a2 + a1 and |a0 + a2 - a1|.  */
+  ta[k] = Limbs::add (ta, a, k, a + 2 * k, ah);
+  tb[k] = Limbs::add (tb, b, k, b + 2 * k, bh);
+  Limbs::add (ea, ta, k + 1, a + k, k);
+  Limbs::add (eb, tb, k + 1, b + k, k);
+  Limbs::mul (v1, ea, k + 1, eb, k + 1, scratch);
+  bool vm1Sign = Limbs::subAbs (ea, ta, k + 1, a + k, k);
+  vm1Sign ^= Limbs::subAbs (eb, tb, k + 1, b + k, k);
+  Limbs::mul (vm1, ea, k + 1, eb, k + 1, scratch);
+
+  /* a0 + 2 a1 + 4 a2.  */
+  memcpy (ea, a, k << 3);
+  memcpy (eb, b, k << 3);
+  ea[k] = Limbs::addMul1 (ea, k, a + k, k, 2);
+  eb[k] = Limbs::addMul1 (eb, k, b + k, k, 2);
+  Limbs::addMul1 (ea, k + 1, a + 2 * k, ah, 4);
+  Limbs::addMul1 (eb, k + 1, b + 2 * k, bh, 4);
+  Limbs::mul (v2, ea, k + 1, eb, k + 1, scratch);
+
+  const int infLen = ah + bh;
+  uint64_t* const v0 = dst;
+  uint64_t* const vInf = dst + 4 * k;
+  Limbs::mul (v0, a, k, b, k, scratch);
+  if (ah >= bh)
+    Limbs::mul (vInf, a + 2 * k, ah, b + 2 * k, bh, scratch);
+  else
+    Limbs::mul (vInf, b + 2 * k, bh, a + 2 * k, ah, scratch);
+
+  interpolateToom3 (dst, an + bn, k, infLen, v1, vm1, vm1Sign, v2);
+}
+
+/* Requires an >= bn > 3 ceil (an / 4). Evaluates a and b, split into four
+   pieces of k cells, at 0, 1, -1, 2, -2, 1/2 and infinity. The even and odd
+   parts of the product polynomial are separated first, which leaves only
+   exact divisions by 2, 3 and 5 in the interpolation.  */
+static void mulToom4 (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn, uint64_t* scratch) {
+  const int k = an + 3 >> 2;
+  const int ah = an - 3 * k;
+  const int bh = bn - 3 * k;
+  const int len = 2 * k + 2;
+  uint64_t* ta = scratch;
+  uint64_t* tb = ta + k + 1;
+  uint64_t* oa = tb + k + 1;
+  uint64_t* ob = oa + k + 1;
+  uint64_t* ea = ob + k + 1;
+  uint64_t* eb = ea + k + 1;
+  uint64_t* v1 = eb + k + 1;
+  uint64_t* vm1 = v1 + len;
+  uint64_t* v2 = vm1 + len;
+  uint64_t* vm2 = v2 + len;
+  uint64_t* vh = vm2 + len;
+  uint64_t* t = vh + len;
+  scratch = t + len;
+
+  /* Even part a0 + a2 and odd part a1 + a3.  */
+  ta[k] = Limbs::add (ta, a, k, a + 2 * k, k);
+  tb[k] = Limbs::add (tb, b, k, b + 2 * k, k);
+  oa[k] = Limbs::add (oa, a + k, k, a + 3 * k, ah);
+  ob[k] = Limbs::add (ob, b + k, k, b + 3 * k, bh);
+  Limbs::add (ea, ta, k + 1, oa, k + 1);
+  Limbs::add (eb, tb, k + 1, ob, k + 1);
+  Limbs::mul (v1, ea, k + 1, eb, k + 1, scratch);
+  bool vm1Sign = Limbs::subAbs (ea, ta, k + 1, oa, k + 1);
+  vm1Sign ^= Limbs::subAbs (eb, tb, k + 1, ob, k + 1);
+  Limbs::mul (vm1, ea, k + 1, eb, k + 1, scratch);
+
+  /* Even part a0 + 4 a2 and odd part 2 a1 + 8 a3.  */
+  memcpy (ta, a, k << 3);
+  memcpy (tb, b, k << 3);
+  ta[k] = Limbs::addMul1 (ta, k, a + 2 * k, k, 4);
+  tb[k] = Limbs::addMul1 (tb, k, b + 2 * k, k, 4);
+  memcpy (oa, a + k, k << 3);
+  memcpy (ob, b + k, k << 3);
+  oa[k] = 0;
+  ob[k] = 0;
+  Limbs::addMul1 (oa, k + 1, a + 3 * k, ah, 4);
+  Limbs::addMul1 (ob, k + 1, b + 3 * k, bh, 4);
+  Limbs::mul1 (oa, oa, k + 1, 2);
+  Limbs::mul1 (ob, ob, k + 1, 2);
+  Limbs::add (ea, ta, k + 1, oa, k + 1);
+  Limbs::add (eb, tb, k + 1, ob, k + 1);
+  Limbs::mul (v2, ea, k + 1, eb, k + 1, scratch);
+  bool vm2Sign = Limbs::subAbs (ea, ta, k + 1, oa, k + 1);
+  vm2Sign ^= Limbs::subAbs (eb, tb, k + 1, ob, k + 1);
+  Limbs::mul (vm2, ea, k + 1, eb, k + 1, scratch);
+
+  /* 8 a0 + 4 a1 + 2 a2 + a3, i.e. 8 a(1/2).  */
+  memcpy (ea, a, k << 3);
+  memcpy (eb, b, k << 3);
+  ea[k] = 0;
+  eb[k] = 0;
+  for (int i = 1; i < 4; ++i) {
+    const int n = i < 3 ? k : ah;
+    Limbs::mul1 (ea, ea, k + 1, 2);
+    Limbs::add (ea, ea, k + 1, a + i * k, n);
+  }
+  for (int i = 1; i < 4; ++i) {
+    const int n = i < 3 ? k : bh;
+    Limbs::mul1 (eb, eb, k + 1, 2);
+    Limbs::add (eb, eb, k + 1, b + i * k, n);
+  }
+  Limbs::mul (vh, ea, k + 1, eb, k + 1, scratch);
+
+  const int infLen = ah + bh;
+  uint64_t* const v0 = dst;
+  uint64_t* const vInf = dst + 6 * k;
+  Limbs::mul (v0, a, k, b, k, scratch);
+  if (ah >= bh)
+    Limbs::mul (vInf, a + 3 * k, ah, b + 3 * k, bh, scratch);
+  else
+    Limbs::mul (vInf, b + 3 * k, bh, a + 3 * k, ah, scratch);
+
+  interpolateToom4 (dst, an + bn, k, infLen, v1, vm1, vm1Sign, v2, vm2, vm2Sign, vh, t);
+}
+
+/* Multiplies b by consecutive pieces of a of bn cells, adding each partial
+   product to the cells of the previous one it overlaps.  */
+static void mulUnbalanced (uint64_t* dst, const uint64_t* a, const int an, const uint64_t* b, const int bn, uint64_t* scratch) {
+  uint64_t* overlap = scratch;
+  scratch += bn;
+
+  Limbs::mul (dst, a, bn, b, bn, scratch);
+  for (int i = bn; i < an; i += bn) {
+    const int len = an - i < bn ? an - i : bn;
+    memcpy (overlap, dst + i, bn << 3);
+    if (len == bn)
+      Limbs::mul (dst + i, a + i, len, b, bn, scratch);
+    else
+      Limbs::mul (dst + i, b, bn, a + i, len, scratch);
+    Limbs::add (dst + i, dst + i, len + bn, overlap, bn);
+  }
+}
+
+/* a^2 = a1^2 B^2m + (a0^2 + a1^2 - (a0 - a1)^2) B^m + a0^2.  */
+static void sqrKaratsuba (uint64_t* dst, const uint64_t* a, const int n, uint64_t* scratch) {
+  const int m = n + 1 >> 1;
+  const int ah = n - m;
+  uint64_t* d = scratch;
+  uint64_t* dd = d + m;
+  uint64_t* mid = dd + 2 * m;
+  scratch = mid + 2 * m + 1;
+
+  Limbs::subAbs (d, a, m, a + m, ah);
+  Limbs::sqr (dst, a, m, scratch);
+  Limbs::sqr (dst + 2 * m, a + m, ah, scratch);
+  Limbs::sqr (dd, d, m, scratch);
+
+  mid[2 * m] = Limbs::add (mid, dst, 2 * m, dst + 2 * m, 2 * ah);
+  Limbs::sub (mid, mid, 2 * m + 1, dd, 2 * m);
+  addCoefficient (dst, 2 * n, m, mid, 2 * m + 1);
+}
+
+/* Toom-3 with both operands equal, so that v(-1) is never negative.  */
+static void sqrToom3 (uint64_t* dst, const uint64_t* a, const int n, uint64_t* scratch) {
+  const int k = (n + 2) / 3;
+  const int ah = n - 2 * k;
+  const int len = 2 * k + 2;
+  uint64_t* ta = scratch;
+  uint64_t* ea = ta + k + 1;
+  uint64_t* v1 = ea + k + 1;
+  uint64_t* vm1 = v1 + len;
+  uint64_t* v2 = vm1 + len;
+  scratch = v2 + len;
+
+  ta[k] = Limbs::add (ta, a, k, a + 2 * k, ah);
+  Limbs::add (ea, ta, k + 1, a + k, k);
+  Limbs::sqr (v1, ea, k + 1, scratch);
+  Limbs::subAbs (ea, ta, k + 1, a + k, k);
+  Limbs::sqr (vm1, ea, k + 1, scratch);
+
+  memcpy (ea, a, k << 3);
+  ea[k] = Limbs::addMul1 (ea, k, a + k, k, 2);
+  Limbs::addMul1 (ea, k + 1, a + 2 * k, ah, 4);
+  Limbs::sqr (v2, ea, k + 1, scratch);
+
+  Limbs::sqr (dst, a, k, scratch);
+  Limbs::sqr (dst + 4 * k, a + 2 * k, ah, scratch);
+
+  interpolateToom3 (dst, 2 * n, k, 2 * ah, v1, vm1, false, v2);
+}
+
+/* Toom-4 with both operands equal, so that v(-1) and v(-2) are never
+   negative.  */
+static void sqrToom4 (uint64_t* dst, const uint64_t* a, const int n, uint64_t* scratch) {
+  const int k = n + 3 >> 2;
+  const int ah = n - 3 * k;
+  const int len = 2 * k + 2;
+  uint64_t* ta = scratch;
+  uint64_t* oa = ta + k + 1;
+  uint64_t* ea = oa + k + 1;
+  uint64_t* v1 = ea + k + 1;
+  uint64_t* vm1 = v1 + len;
+  uint64_t* v2 = vm1 + len;
+  uint64_t* vm2 = v2 + len;
+  uint64_t* vh = vm2 + len;
+  uint64_t* t = vh + len;
+  scratch = t + len;
+
+  ta[k] = Limbs::add (ta, a, k, a + 2 * k, k);
+  oa[k] = Limbs::add (oa, a + k, k, a + 3 * k, ah);
+  Limbs::add (ea, ta, k + 1, oa, k + 1);
+  Limbs::sqr (v1, ea, k + 1, scratch);
+  Limbs::subAbs (ea, ta, k + 1, oa, k + 1);
+  Limbs::sqr (vm1, ea, k + 1, scratch);
+
+  memcpy (ta, a, k << 3);
+  ta[k] = Limbs::addMul1 (ta, k, a + 2 * k, k, 4);
+  memcpy (oa, a + k, k << 3);
+  oa[k] = 0;
+  Limbs::addMul1 (oa, k + 1, a + 3 * k, ah, 4);
+  Limbs::mul1 (oa, oa, k + 1, 2);
+  Limbs::add (ea, ta, k + 1, oa, k + 1);
+  Limbs::sqr (v2, ea, k + 1, scratch);
+  Limbs::subAbs (ea, ta, k + 1, oa, k + 1);
+  Limbs::sqr (vm2, ea, k + 1, scratch);
+
+  memcpy (ea, a, k << 3);
+  ea[k] = 0;
+  for (int i = 1; i < 4; ++i) {
+    Limbs::mul1 (ea, ea, k + 1, 2);
+    Limbs::add (ea, ea, k + 1, a + i * k, i < 3 ? k : ah);
+  }
+  Limbs::sqr (vh, ea, k + 1, scratch);
+
+  Limbs::sqr (dst, a, k, scratch);
+  Limbs::sqr (dst + 6 * k, a + 3 * k, ah, scratch);
+
+  interpolateToom4 (dst, 2 * n, k, 2 * ah, v1, vm1, false, v2, vm2, false, vh, t);
+}
@@ -0,0 +1,177 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef SKYLGE__MATH__LIMBS_INCLUDED
+#define SKYLGE__MATH__LIMBS_INCLUDED
+
+#include <stdint.h>
+
+/* Operand sizes (in cells of the smaller operand) from which multiplication
+   switches to Karatsuba, Toom-3 and Toom-4 respectively.  */
+#ifndef KARATSUBA_THRESHOLD
+# define KARATSUBA_THRESHOLD 24
+#endif
+#ifndef TOOM3_THRESHOLD
+# define TOOM3_THRESHOLD 96
+#endif
+#ifndef TOOM4_THRESHOLD
+# define TOOM4_THRESHOLD 256
+#endif
+
+/* Operand sizes (in cells) from which squaring switches to Karatsuba, Toom-3
+   and Toom-4 respectively.  */
+#ifndef SQR_KARATSUBA_THRESHOLD
+# define SQR_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef SQR_TOOM3_THRESHOLD
+# define SQR_TOOM3_THRESHOLD 128
+#endif
+#ifndef SQR_TOOM4_THRESHOLD
+# define SQR_TOOM4_THRESHOLD 320
+#endif
+
+/* Divisor size (in cells) from which division switches to the recursive
+   method of Burnikel and Ziegler.  */
+#ifndef DIV_DC_THRESHOLD
+# define DIV_DC_THRESHOLD 48
+#endif
+
+/* Size (in cells) below which reciprocals are computed by division rather
+   than Newton iteration, and divisor size from which dividing by a cached
+   reciprocal beats div.  */
+#ifndef INV_NEWTON_THRESHOLD
+# define INV_NEWTON_THRESHOLD 64
+#endif
+#ifndef DIV_NEWTON_THRESHOLD
+# define DIV_NEWTON_THRESHOLD 1000
+#endif
+
+/* Size (in cells) from which IntegerOps::toString converts by divide and
+   conquer.  */
+#ifndef TOSTRING_DC_THRESHOLD
+# define TOSTRING_DC_THRESHOLD 20
+#endif
+
+/* Number of 18 digit chunks from which IntegerOps::parse assembles the value
+   by divide and conquer.  */
+#ifndef PARSE_DC_THRESHOLD
+# define PARSE_DC_THRESHOLD 128
+#endif
+
+#if KARATSUBA_THRESHOLD < 4 || TOOM3_THRESHOLD < 5 || TOOM4_THRESHOLD < 10
+# error Multiplication thresholds too small for the operands to be split.
+#endif
+#if SQR_KARATSUBA_THRESHOLD < 4 || SQR_TOOM3_THRESHOLD < 5 || SQR_TOOM4_THRESHOLD < 10
+# error Squaring thresholds too small for the operand to be split.
+#endif
+#if DIV_DC_THRESHOLD < 4 || INV_NEWTON_THRESHOLD < 4 || DIV_NEWTON_THRESHOLD < 2
+# error Division thresholds too small for the divisor to be split.
+#endif
+#if PARSE_DC_THRESHOLD < 2
+# error Parse threshold too small for the chunks to be split.
+#endif
+
+/* Routines operating on arrays of cells (least significant cell first), each
+   cell holding CAL_B bits. Operands are not required to be normalised, i.e.
+   they may have leading zero cells.  */
+namespace Limbs {
+
+  /* dst = a + b, where an >= bn; returns the carry. dst may be a.  */
+  bool add (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* dst[0..dn) += src[0..sn) * m, where dn >= sn and m < 2^CAL_B; returns the
+     cell carried out of dst[dn - 1].  */
+  uint64_t addMul1 (uint64_t* dst, int dn, const uint64_t* src, int sn, uint64_t m);
+
+  /* Returns -1, 0 or 1 if a is less than, equal to or greater than b.  */
+  int cmp (const uint64_t* a, const uint64_t* b, int n);
+
+  /* Divides n[0..nn] by d[0..dn), where dn >= 2, the most significant bit of
+     d[dn - 1] is set and n[nn-dn+1..nn] < d. Stores the quotient in
+     q[0..nn-dn] and leaves the remainder in n[0..dn). scratch must hold at
+     least divScratchSize (dn) cells.  */
+  void div (uint64_t* q, uint64_t* n, int nn, const uint64_t* d, int dn, uint64_t* scratch);
+
+  /* As div, using schoolbook division (Knuth's algorithm D) without
+     scratch.  */
+  void divBasecase (uint64_t* q, uint64_t* n, int nn, const uint64_t* d, int dn);
+
+  /* dst = src / d, where d is odd, less than 2^CAL_B and known to divide src.
+     dst may be src.  */
+  void divExact (uint64_t* dst, const uint64_t* src, int n, uint64_t d);
+
+  /* q = src / d, where 0 < d < 2^CAL_B; returns the remainder. q may be
+     src.  */
+  uint64_t divRem1 (uint64_t* q, const uint64_t* src, int n, uint64_t d);
+
+  /* As divRem1, where d has been shifted left by shift bits so that its most
+     significant bit is set and inv = calInverse (d).  */
+  uint64_t divRem1Preinv (uint64_t* q, const uint64_t* src, int n, uint64_t d, int shift, uint64_t inv);
+
+  /* Number of scratch cells needed by div for divisors of at most n cells.  */
+  int divScratchSize (int n);
+
+  /* Returns src mod (d >> shift), with d, shift and inv as in
+     divRem1Preinv.  */
+  uint64_t mod1Preinv (const uint64_t* src, int n, uint64_t d, int shift, uint64_t inv);
+
+  /* dst[0..an+bn) = a * b, where an >= bn > 0. dst may not overlap a or b.
+     scratch must hold at least mulScratchSize (an) cells.  */
+  void mul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* scratch);
+
+  /* dst = src * m, where m < 2^CAL_B; returns the cell carried out. dst may
+     be src.  */
+  uint64_t mul1 (uint64_t* dst, const uint64_t* src, int n, uint64_t m);
+
+  /* dst[0..an+bn) = a * b using the schoolbook method, or the IFMA kernel
+     where Ifma::active (). dst may not overlap a or b.  */
+  void mulBasecase (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* Number of scratch cells needed by mul and sqr for operands of at most n
+     cells.  */
+  int mulScratchSize (int n);
+
+  /* dst = src << bits, where 0 < bits < CAL_B; returns the bits shifted out
+     of src[n - 1]. dst may be src.  */
+  uint64_t shl (uint64_t* dst, const uint64_t* src, int n, int bits);
+
+  /* dst = src >> bits, where 0 < bits < CAL_B. dst may be src.  */
+  void shr (uint64_t* dst, const uint64_t* src, int n, int bits);
+
+  /* dst[0..2n) = a^2, where n > 0. dst may not overlap a. scratch must hold
+     at least mulScratchSize (n) cells.  */
+  void sqr (uint64_t* dst, const uint64_t* a, int n, uint64_t* scratch);
+
+  /* dst[0..2n) = a^2 using the schoolbook method, computing each cross
+     product once, or the IFMA kernel where Ifma::active (). dst may not
+     overlap a.  */
+  void sqrBasecase (uint64_t* dst, const uint64_t* a, int n);
+
+  /* dst = a - b, where an >= bn; returns the borrow. dst may be a.  */
+  bool sub (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* dst = |a - b|, where an >= bn; returns true if a < b. dst may be a.  */
+  bool subAbs (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+  /* dst[0..dn) -= src[0..sn) * m, where dn >= sn and m < 2^CAL_B; returns the
+     cell borrowed out of dst[dn - 1].  */
+  uint64_t subMul1 (uint64_t* dst, int dn, const uint64_t* src, int sn, uint64_t m);
+}
+
+#endif
@@ -0,0 +1,197 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <skylge/math/CellOps.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "cellOpsTests.h"
+
+/* The operands are at most this many bits, so that the results can be
+   checked with 64 bit arithmetic.  */
+#define VALUE_BITS 60
+
+static int maxCells (void) {
+  return VALUE_BITS / CellOps::bits ();
+}
+
+static uint64_t cellMask (void) {
+  return ((uint64_t) 1 << CellOps::bits ()) - 1;
+}
+
+static uint64_t mask (int cells) {
+  return cells > 0 ? (uint64_t) -1 >> 64 - cells * CellOps::bits () : 0;
+}
+
+/* Returns a random value of at most the given number of cells, with many
+   cells all zeros or all ones.  */
+static uint64_t randomValue (Random& random, int cells) {
+  uint64_t result = 0;
+  for (int i = 0; i < cells; ++i) {
+    const int kind = random.nextInt (4);
+    const uint64_t cell = kind == 0 ? 0 : kind == 1 ? cellMask () : (uint64_t) random.nextInt () & cellMask ();
+    result |= cell << i * CellOps::bits ();
+  }
+  return result;
+}
+
+static void toCells (uint64_t* dst, uint64_t value, int cells) {
+  for (int i = 0; i < cells; ++i) {
+    dst[i] = value & cellMask ();
+    value >>= CellOps::bits ();
+  }
+}
+
+static uint64_t fromCells (const uint64_t* src, int cells) {
+  uint64_t result = 0;
+  for (int i = cells - 1; i > -1; --i) {
+    result = result << CellOps::bits () | src[i];
+  }
+  return result;
+}
+
+static bool testAddSub (void) {
+  Random random;
+  uint64_t a[VALUE_BITS];
+  uint64_t b[VALUE_BITS];
+  uint64_t dst[VALUE_BITS];
+
+  const int max = 100000;
+  ErrorExamples errorExamples ("Error for: A=%lX, B=%lX.\n");
+  ProgressionBar::init ("CellOps::add, CellOps::sub", max);
+  for (int i = 0; i < max; ++i) {
+    const int an = random.nextInt (maxCells ()) + 1;
+    const int bn = random.nextInt (an + 1);
+    const uint64_t valA = randomValue (random, an);
+    const uint64_t valB = randomValue (random, bn);
+    toCells (a, valA, an);
+    toCells (b, valB, bn);
+
+    bool carry = CellOps::add (dst, a, an, b, bn);
+    bool error = fromCells (dst, an) != (valA + valB & mask (an)) || carry != (valA + valB > mask (an));
+    carry = CellOps::sub (a, a, an, b, bn);
+    error |= fromCells (a, an) != (valA - valB & mask (an)) || carry != (valA < valB);
+    if (error) {
+      errorExamples.add (valA, valB);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testDivRem1 (void) {
+  Random random;
+  uint64_t src[VALUE_BITS];
+  uint64_t q[VALUE_BITS];
+
+  const int max = 100000;
+  ErrorExamples errorExamples ("Error for: value=%lX, d=%lX.\n");
+  ProgressionBar::init ("CellOps::divRem1, CellOps::cmp", max);
+  for (int i = 0; i < max; ++i) {
+    const int n = random.nextInt (maxCells ()) + 1;
+    const uint64_t value = randomValue (random, n);
+    const uint64_t d = randomValue (random, 1) | 1;
+    toCells (src, value, n);
+
+    const uint64_t rem = CellOps::divRem1 (q, src, n, d);
+    bool error = fromCells (q, n) != value / d || rem != value % d;
+    const int cmp = CellOps::cmp (q, src, n);
+    error |= cmp != (d == 1 ? 0 : value == 0 ? 0 : -1);
+    if (error) {
+      errorExamples.add (value, d);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testMul1 (void) {
+  Random random;
+  uint64_t src[VALUE_BITS];
+  uint64_t dst[VALUE_BITS];
+
+  const int max = 100000;
+  ErrorExamples errorExamples ("Error for: value=%lX, m=%lX, addend=%lX.\n");
+  ProgressionBar::init ("CellOps::mul1, CellOps::addMul1, CellOps::subMul1", max);
+  for (int i = 0; i < max; ++i) {
+    const int n = random.nextInt (maxCells () - 1) + 1;
+    const uint64_t value = randomValue (random, n);
+    const uint64_t m = randomValue (random, 1);
+    const uint64_t addend = randomValue (random, n);
+    const uint64_t product = value * m;
+    toCells (src, value, n);
+
+    uint64_t high = CellOps::mul1 (dst, src, n, m);
+    bool error = fromCells (dst, n) != (product & mask (n)) || high != product >> n * CellOps::bits ();
+    toCells (dst, addend, n);
+    high = CellOps::addMul1 (dst, src, n, m);
+    error |= fromCells (dst, n) != (addend + product & mask (n)) || high != addend + product >> n * CellOps::bits ();
+    toCells (dst, addend, n);
+    high = CellOps::subMul1 (dst, src, n, m);
+    const uint64_t borrowed = product - addend + mask (n) >> n * CellOps::bits ();
+    error |= fromCells (dst, n) != (addend - product & mask (n)) || high != (addend >= product ? 0 : borrowed);
+    if (error) {
+      errorExamples.add (value, m, addend);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testShift (void) {
+  Random random;
+  uint64_t buf[2 * VALUE_BITS];
+
+  const int max = 100000;
+  ErrorExamples errorExamples ("Error for: value=%lX, count=%ld, offset=%ld.\n");
+  ProgressionBar::init ("CellOps::shl, CellOps::shr", max);
+  for (int i = 0; i < max; ++i) {
+    const int n = random.nextInt (maxCells ()) + 1;
+    const int count = random.nextInt (CellOps::bits () - 1) + 1;
+    const int offset = random.nextInt (3);
+    const uint64_t value = randomValue (random, n);
+
+    memset (buf, 0, sizeof (buf));
+    toCells (buf, value, n);
+    const uint64_t out = CellOps::shl (buf + offset, buf, n, count);
+    bool error = fromCells (buf + offset, n) != (value << count & mask (n)) || out != value >> n * CellOps::bits () - count;
+
+    memset (buf, 0, sizeof (buf));
+    toCells (buf + offset, value, n);
+    CellOps::shr (buf, buf + offset, n, count);
+    error |= fromCells (buf, n) != value >> count;
+    if (error) {
+      errorExamples.add (value, (int64_t) count, (int64_t) offset);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+const test_fn_t cellOpsTests[] = {
+  testAddSub,
+  testMul1,
+  testShift,
+  testDivRem1
+};
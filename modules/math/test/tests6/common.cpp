@@ -0,0 +1,52 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "common.h"
+
+/* The chunks are imported as bytes, most significant first, which takes
+   time linear in their number also for the sizes of CAL_B = 64.  */
+void setRandomValue (IntegerOps& ops, Integer& dst, Random& random, int chunks) {
+  std::vector<unsigned char> bytes (3 * chunks + 1);
+  for (int i = 0; i < chunks; ++i) {
+    const int chunk = random.nextInt (0x1000000);
+    bytes[3 * i] = chunk >> 16;
+    bytes[3 * i + 1] = chunk >> 8;
+    bytes[3 * i + 2] = chunk;
+  }
+  if (!ops.importBytes (dst, bytes.data (), chunks, 1, 3, 1)) {
+    printf ("common.cpp: setRandomValue: %d chunks do not fit.\n", chunks);
+    exit (EXIT_FAILURE);
+  }
+  if (random.nextInt (2) == 1) {
+    Integer value = dst;
+    dst = 0;
+    ops.sub (dst, value);
+  }
+}
+
+int64_t truncated (const int64_t value, const int cells) {
+  if (CAL_B * cells > 62)
+    return value;
+
+  const int64_t magnitude = (value < 0 ? -value : value) & ((int64_t) 1 << CAL_B * cells) - 1;
+  return value < 0 ? -magnitude : magnitude;
+}
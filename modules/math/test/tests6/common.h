@@ -0,0 +1,64 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COMMON_INCLUDED
+#define COMMON_INCLUDED
+
+#include <skylge/math/Integer.h>
+#include <skylge/math/IntegerAllocator.h>
+#include <skylge/math/IntegerOps.h>
+#include <skylge/testutils/Random.h>
+
+/* The tests are built for cells of CAL_B bits, as the library they are
+   linked with.  */
+#ifndef CAL_B
+# error CAL_B should be defined as for the library tested.
+#endif
+
+/* Number of chunks of 24 bits (see setRandomValue) taking as many cells as
+   chunks chunks do in cells of 6 bits, so that the tests reach the same
+   sizes, and thresholds, for every CAL_B.  */
+#define CHUNKS(chunks) ((chunks) * CAL_B / 6)
+
+/* Counts the buffers it hands out and takes back.  */
+class CountingAllocator : public IntegerAllocator {
+public:
+  int allocated = 0;
+  int released = 0;
+
+  virtual uint64_t* allocate (int size) {
+    ++allocated;
+    return new uint64_t[size];
+  }
+
+  virtual void release (uint64_t* buf, int size) {
+    ++released;
+    delete[] buf;
+  }
+};
+
+/* Sets dst to a random value of (at most) 24 * chunks bits and random sign.  */
+void setRandomValue (IntegerOps& ops, Integer& dst, Random& random, int chunks);
+
+/* Returns value as it ends up in an Integer of the given number of cells
+   when it does not fit: its magnitude modulo 2^(CAL_B cells), with its sign.
+   Results other than value mean a carry.  */
+int64_t truncated (int64_t value, int cells);
+
+#endif
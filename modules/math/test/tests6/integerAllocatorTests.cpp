@@ -0,0 +1,232 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <skylge/math/Integer.h>
+#include <skylge/math/IntegerAllocator.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "common.h"
+#include "integerAllocatorTests.h"
+
+/* Fills size cells at buf with a pattern depending on seed; returns true if
+   they already held that pattern when check is set.  */
+static bool pattern (uint64_t* buf, int size, uint64_t seed, bool check) {
+  for (int i = 0; i < size; ++i) {
+    const uint64_t value = seed * 0x9E3779B97F4A7C15 + i;
+    if (check) {
+      if (buf[i] != value)
+        return false;
+    } else {
+      buf[i] = value;
+    }
+  }
+  return true;
+}
+
+static bool testCustomAllocator (void) {
+  CountingAllocator allocator;
+  ErrorExamples errorExamples ("Error for: size=%ld.\n");
+  ProgressionBar::init ("IntegerAllocator::set (IntegerAllocator*)", 3);
+
+  const int sizes[] = {3, 11, 400};
+  for (int size : sizes) {
+    IntegerAllocator::set (&allocator);
+    allocator.allocated = 0;
+    allocator.released = 0;
+    {
+      Integer bigint (size);
+      bigint = 1000;
+      Integer copied (bigint);
+      Integer moved (std::move (copied));
+      bool error = (int) moved != 1000;
+      if (error) {
+        errorExamples.add ((int64_t) size);
+      }
+    }
+    IntegerAllocator::set (NULL);
+
+    /* Inline Integers do not allocate.  */
+    const int expected = size <= INTEGER_INLINE_SIZE ? 0 : 2;
+    bool error = allocator.allocated != expected || allocator.released != expected;
+    error |= IntegerAllocator::get () != &IntegerPool::instance ();
+    if (error) {
+      errorExamples.add ((int64_t) size);
+    }
+    ProgressionBar::update (error);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testHugePages (void) {
+  Random random;
+  IntegerPool& pool = IntegerPool::instance ();
+  pool.setHugePageThreshold (1024);
+  std::vector<uint64_t*> buffers;
+  std::vector<int> sizes;
+
+  const int max = 200;
+  ErrorExamples errorExamples ("Error for: size=%ld.\n");
+  ProgressionBar::init ("IntegerPool::setHugePageThreshold (int)", max);
+  for (int i = 0; i < max; ++i) {
+    const int size = 1024 + random.nextInt (16384 - 1024 + 1);
+    uint64_t* buf = pool.allocate (size);
+    pattern (buf, size, i, false);
+    buffers.push_back (buf);
+    sizes.push_back (size);
+  }
+  for (int i = 0; i < max; ++i) {
+    bool error = !pattern (buffers[i], sizes[i], i, true);
+    if (error) {
+      errorExamples.add ((int64_t) sizes[i]);
+    }
+    pool.release (buffers[i], sizes[i]);
+    ProgressionBar::update (error);
+  }
+  pool.setHugePageThreshold (0);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testPool (void) {
+  Random random;
+  IntegerPool& pool = IntegerPool::instance ();
+  std::vector<uint64_t*> buffers;
+  std::vector<int> sizes;
+  std::vector<int> seeds;
+
+  const int max = 20000;
+  ErrorExamples errorExamples ("Error for: size=%ld.\n");
+  ProgressionBar::init ("IntegerPool::allocate (int)", max + 2);
+  for (int i = 0; i < max; ++i) {
+    const int size = random.nextInt (2) == 0 ? 1 + random.nextInt (40) : 1 + random.nextInt (20000);
+    uint64_t* buf = pool.allocate (size);
+    pattern (buf, size, i, false);
+    buffers.push_back (buf);
+    sizes.push_back (size);
+    seeds.push_back (i);
+
+    /* Release about half of the buffers, in random order.  */
+    if (random.nextInt (2) == 0) {
+      const int j = random.nextInt (buffers.size ());
+      bool error = !pattern (buffers[j], sizes[j], seeds[j], true);
+      if (error) {
+        errorExamples.add ((int64_t) sizes[j]);
+      }
+      ProgressionBar::update (error);
+      pool.release (buffers[j], sizes[j]);
+      buffers[j] = buffers.back ();
+      sizes[j] = sizes.back ();
+      seeds[j] = seeds.back ();
+      buffers.pop_back ();
+      sizes.pop_back ();
+      seeds.pop_back ();
+    } else {
+      ProgressionBar::update (false);
+    }
+  }
+  for (size_t j = 0; j < buffers.size (); ++j) {
+    pool.release (buffers[j], sizes[j]);
+  }
+
+  /* A released buffer is handed out again for a size of the same class.  */
+  uint64_t* buf = pool.allocate (300);
+  pool.release (buf, 300);
+  bool error = pool.allocate (290) != buf;
+  pool.release (buf, 290);
+  if (error) {
+    errorExamples.add ((int64_t) 290);
+  }
+  ProgressionBar::update (error);
+
+  /* Sizes beyond the pool are allocated directly.  */
+  buf = pool.allocate (40000);
+  pattern (buf, 40000, 1, false);
+  error = !pattern (buf, 40000, 1, true);
+  pool.release (buf, 40000);
+  if (error) {
+    errorExamples.add ((int64_t) 40000);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testThreads (void) {
+  const int threadCount = 8;
+  const int max = 40000;
+  std::atomic<int> errors (0);
+  ErrorExamples errorExamples ("Error for: thread=%ld.\n");
+  ProgressionBar::init ("IntegerPool::allocate (int) [threads]", threadCount);
+
+  /* Integers created in one thread are destroyed in another, through the
+     vectors handed over.  */
+  std::vector<std::vector<Integer>> values (threadCount);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back ([t, &values, &errors] () {
+      Random random;
+      std::vector<Integer> kept;
+      for (int i = 0; i < max; ++i) {
+        const int size = 4 + random.nextInt (60);
+        Integer bigint (size);
+        bigint = (int64_t) i * (t + 1);
+        Integer copied (bigint);
+        if ((int64_t) copied != (int64_t) i * (t + 1))
+          ++errors;
+        if (i % 16 == 0)
+          kept.push_back (std::move (copied));
+      }
+      values[t] = std::move (kept);
+    });
+  }
+  for (int t = 0; t < threadCount; ++t) {
+    threads[t].join ();
+  }
+
+  for (int t = 0; t < threadCount; ++t) {
+    bool error = errors.load () != 0;
+    for (size_t i = 0; i < values[t].size (); ++i) {
+      error |= (int64_t) values[t][i] != (int64_t) (16 * i) * (t + 1);
+    }
+    values[t].clear ();
+    if (error) {
+      errorExamples.add ((int64_t) t);
+    }
+    ProgressionBar::update (error);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+const test_fn_t integerAllocatorTests[] = {
+  testPool,
+  testCustomAllocator,
+  testHugePages,
+  testThreads
+};
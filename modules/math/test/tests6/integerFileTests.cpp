@@ -0,0 +1,162 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <vector>
+#include <skylge/math/IntegerFile.h>
+#include <skylge/math/IntegerOps.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "common.h"
+#include "integerFileTests.h"
+
+/* Returns whether reading fileName throws.  */
+static bool isRejected (const char* fileName) {
+  try {
+    IntegerFile file (fileName);
+    return false;
+  } catch (std::runtime_error& x) {
+    return true;
+  }
+}
+
+/* Overwrites the cell of the payload at index with value.  */
+static void overwriteCell (const char* fileName, long index, uint64_t value) {
+  FILE* file = fopen (fileName, "r+b");
+  fseek (file, 64 + 8 * index, SEEK_SET);
+  fwrite (&value, 8, 1, file);
+  fclose (file);
+}
+
+static bool testInvalidFiles (void) {
+  char fileName[] = "/tmp/integerFileTestsXXXXXX";
+  close (mkstemp (fileName));
+  IntegerOps ops (40);
+  Integer bigint = ops.createInteger (-123456789);
+  bigint.shl (100);
+
+  ProgressionBar::init ("IntegerFile (const char*) [invalid files]", 6);
+
+  /* Empty file.  */
+  bool error = !isRejected (fileName);
+  ProgressionBar::update (error);
+
+  IntegerFileWriter writer (fileName);
+  writer.add (bigint);
+  writer.close ();
+  const bool valid = !isRejected (fileName);
+  error |= !valid;
+  ProgressionBar::update (!valid);
+
+  /* Corrupt magic.  */
+  FILE* file = fopen (fileName, "r+b");
+  fputc ('X', file);
+  fclose (file);
+  const bool badMagic = !isRejected (fileName);
+  error |= badMagic;
+  ProgressionBar::update (badMagic);
+
+  /* Truncated index.  */
+  IntegerFileWriter writer2 (fileName);
+  writer2.add (bigint);
+  writer2.close ();
+  truncate (fileName, 64 + 8 * bigint.max () + 8);
+  const bool truncated = !isRejected (fileName);
+  error |= truncated;
+  ProgressionBar::update (truncated);
+
+  /* Zero top cell.  */
+  IntegerFileWriter writer3 (fileName);
+  writer3.add (bigint);
+  writer3.close ();
+  overwriteCell (fileName, bigint.max () - 1, 0);
+  const bool zeroTop = !isRejected (fileName);
+  error |= zeroTop;
+  ProgressionBar::update (zeroTop);
+
+  /* Cell not less than 2^CAL_B.  */
+  IntegerFileWriter writer4 (fileName);
+  writer4.add (bigint);
+  writer4.close ();
+  overwriteCell (fileName, 0, 0x40);
+  const bool tooLarge = !isRejected (fileName);
+  error |= tooLarge;
+  ProgressionBar::update (tooLarge);
+
+  unlink (fileName);
+  if (error)
+    printf ("Invalid integer file accepted or valid one rejected.\n");
+  return error;
+}
+
+static bool testWriteRead (void) {
+  char fileName[] = "/tmp/integerFileTestsXXXXXX";
+  close (mkstemp (fileName));
+  Random random;
+  IntegerOps ops (400);
+  IntegerOps smallOps (2);
+  Integer small = smallOps.createInteger ();
+
+  const int max = 1000;
+  std::vector<Integer> values;
+  IntegerFileWriter writer (fileName);
+  for (int i = 0; i < max; ++i) {
+    values.push_back (ops.createInteger ());
+    setRandomValue (ops, values[i], random, random.nextInt (i % 10 == 0 ? 100 : 4));
+    writer.add (values[i]);
+  }
+  writer.close ();
+
+  ErrorExamples errorExamples ("Error for: index=%ld, cells=%ld.\n");
+  ProgressionBar::init ("IntegerFile::get (Integer&, size_t)", max + 1);
+  IntegerFile file (fileName);
+  bool error = file.count () != max;
+  if (error) {
+    errorExamples.add (-1, (int64_t) file.count ());
+  }
+  ProgressionBar::update (error);
+  for (int i = 0; i < max && !error; ++i) {
+    const Integer& value = values[i];
+    Integer entry = ops.createInteger (7);
+    bool entryError = !file.get (entry, i) || entry != value;
+    entryError |= file.length (i) != value.max () || file.sign (i) != value.sign ();
+    entryError |= memcmp (file.cells (i), value.buf (), value.max () << 3) != 0;
+    entryError |= ops.mul (file.view (i), file.view (i)) != ops.sqr (value);
+    small = 7;
+    entryError |= file.get (small, i) != (value.max () <= 2) || (value.max () > 2 && (int) small != 7);
+    if (entryError) {
+      errorExamples.add (i, (int64_t) value.max ());
+    }
+    ProgressionBar::update (entryError);
+  }
+
+  unlink (fileName);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+const test_fn_t integerFileTests[] = {
+  testWriteRead,
+  testInvalidFiles
+};
@@ -18,13 +18,16 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <skylge/math/IntegerOps.h>
 #include <skylge/testutils/ErrorExamples.h>
 #include <skylge/testutils/progressionBar.h>
 #include <skylge/testutils/Random.h>
+#include "common.h"
 #include "integerOpsTests.h"
 
 static bool testAdd (void) {
@@ -42,20 +45,8 @@ static bool testAdd (void) {
     bigintA = valA;
     bigintB = valB;
 
-    bool expectedCarry;
-    int64_t expectedSum = valA + valB;
-    if (expectedSum > 0xFFFFFF) {
-      expectedSum &= 0xFFFFFF;
-      expectedCarry = true;
-    } else if (expectedSum == -0x1000000) {
-      expectedSum = 0;
-      expectedCarry = true;
-    } else if (expectedSum < -0x1000000) {
-      expectedSum |= 0x1000000;
-      expectedCarry = true;
-    } else {
-      expectedCarry = false;
-    }
+    const int64_t expectedSum = truncated (valA + valB, 4);
+    const bool expectedCarry = expectedSum != valA + valB;
 
     bool carry = ops.add (bigintA, bigintB);
 
@@ -76,20 +67,8 @@ static bool testAdd (void) {
     bigintA = fixedA[i];
     bigintB = fixedB[i];
 
-    bool expectedCarry;
-    int64_t expectedSum = fixedA[i] + fixedB[i];
-    if (expectedSum > 0xFFFFFF) {
-      expectedSum &= 0xFFFFFF;
-      expectedCarry = true;
-    } else if (expectedSum == -0x1000000) {
-      expectedSum = 0;
-      expectedCarry = true;
-    } else if (expectedSum < -0x1000000) {
-      expectedSum |= 0x1000000;
-      expectedCarry = true;
-    } else {
-      expectedCarry = false;
-    }
+    const int64_t expectedSum = truncated (fixedA[i] + fixedB[i], 4);
+    const bool expectedCarry = expectedSum != fixedA[i] + fixedB[i];
 
     bool carry = ops.add (bigintA, bigintB);
 
@@ -115,20 +94,8 @@ static bool testAddInt (void) {
     for (int j = -0x3FFFF; j < 0x40000; ++j) {
       bigint = j;
 
-      bool expectedCarry;
-      int64_t expectedSum = j + i;
-      if (expectedSum > 0x3FFFF) {
-        expectedSum &= 0x3FFFF;
-        expectedCarry = true;
-      } else if (expectedSum == -0x40000) {
-        expectedSum = 0;
-        expectedCarry = true;
-      } else if (expectedSum < -0x40000) {
-        expectedSum |= 0x40000;
-        expectedCarry = true;
-      } else {
-        expectedCarry = false;
-      }
+      const int64_t expectedSum = truncated (j + i, 3);
+      const bool expectedCarry = expectedSum != j + i;
 
       bool carry = ops.add (bigint, i);
 
@@ -155,6 +122,131 @@ static bool testAddInt (void) {
   return !errorExamples.empty ();
 }
 
+/* Compares the batch versions of add, sub and mul with those for single
+   Integers, for values that fill all cells. A sum that overflows to zero
+   may keep its sign in an Integer, but not in a batch.  */
+static bool testBatch (void) {
+  Random random;
+  const int count = 70;
+
+  const int max = 40;
+  ErrorExamples errorExamples ("Error for: size=%ld, index=%ld.\n");
+  ProgressionBar::init ("IntegerOps::add/sub/mul (IntegerBatch&, ...)", max);
+  for (int i = 0; i < max; ++i) {
+    const int size = 4 * (random.nextInt (2) + 1);
+    IntegerOps ops (size);
+    IntegerBatch batchA (count, size);
+    IntegerBatch batchB (count, size);
+    IntegerBatch sums (count, size);
+    IntegerBatch differences (count, size);
+    IntegerBatch products (count, 2 * size);
+    Integer bigintA = ops.createInteger ();
+    Integer bigintB = ops.createInteger ();
+    for (int j = 0; j < count; ++j) {
+      setRandomValue (ops, bigintA, random, CHUNKS (random.nextInt (size / 4 + 1)));
+      setRandomValue (ops, bigintB, random, CHUNKS (random.nextInt (size / 4 + 1)));
+      if (j % 7 == 0) {
+        bigintB = bigintA;
+      }
+      batchA.set (j, bigintA);
+      batchB.set (j, bigintB);
+      sums.set (j, bigintA);
+      differences.set (j, bigintA);
+    }
+
+    const bool carry = ops.add (sums, batchB);
+    const bool borrow = ops.sub (differences, batchB);
+    ops.mul (products, batchA, batchB);
+
+    bool expectedCarry = false;
+    bool expectedBorrow = false;
+    bool error = false;
+    Integer result = ops.createInteger ();
+    Integer product (2 * size);
+    for (int j = 0; j < count && !error; ++j) {
+      batchA.get (j, bigintA);
+      batchB.get (j, bigintB);
+      Integer expected = bigintA;
+      expectedCarry |= ops.add (expected, bigintB);
+      sums.get (j, result);
+      error = result != expected && !(result.bsr () == 0 && expected.bsr () == 0);
+
+      expected = bigintA;
+      expectedBorrow |= ops.sub (expected, bigintB);
+      differences.get (j, result);
+      error |= result != expected && !(result.bsr () == 0 && expected.bsr () == 0);
+
+      products.get (j, product);
+      error |= product != ops.mul (bigintA, bigintB);
+      if (error) {
+        errorExamples.add (size, (int64_t) j);
+      }
+    }
+    if (!error && (carry != expectedCarry || borrow != expectedBorrow)) {
+      error = true;
+      errorExamples.add (size, (int64_t) -1);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testBytes (void) {
+  Random random;
+  IntegerOps ops (1000);
+  Integer bigint = ops.createInteger ();
+  Integer imported = ops.createInteger ();
+  unsigned char bytes[125 * CAL_B + 10];
+
+  const int max = 600;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, layout=%ld.\n");
+  ProgressionBar::init ("IntegerOps::exportBytes (void*, const Integer&, int, size_t, int)", max + 1);
+  for (int i = 0; i < max; ++i) {
+    const int chunks = CHUNKS (random.nextInt (250));
+    const int order = 2 * random.nextInt (2) - 1;
+    const int size = random.nextInt (10) + 1;
+    const int endian = random.nextInt (3) - 1;
+    setRandomValue (ops, bigint, random, chunks);
+
+    /* Expected: the bytes of |bigint|, taken from its hex digits.  */
+    std::string hex = ops.toHex (bigint);
+    hex.erase (0, hex[0] == '-');
+    const std::string digits = hex.length () % 2 == 0 ? hex : "0" + hex;
+    const size_t byteCount = bigint.bsr () > 0 ? digits.length () / 2 : 0;
+    const size_t count = (byteCount + size - 1) / size;
+    const bool bigEndian = endian > 0 || endian == 0 && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+    unsigned char expected[125 * CAL_B + 10] = {0};
+    for (size_t j = 0; j < byteCount; ++j) {
+      const size_t word = order > 0 ? count - 1 - j / size : j / size;
+      expected[word * size + (bigEndian ? size - 1 - j % size : j % size)] = strtol (digits.substr (digits.length () - 2 * j - 2, 2).c_str (), nullptr, 16);
+    }
+
+    memset (bytes, 0xA5, sizeof (bytes));
+    bool error = ops.exportBytes (bytes, bigint, order, size, endian) != count || memcmp (bytes, expected, count * size) != 0 || bytes[count * size] != 0xA5;
+    imported = 7;
+    error |= !ops.importBytes (imported, bytes, count, order, size, endian) || imported.sign () || ops.toHex (imported) != hex;
+    if (error) {
+      errorExamples.add (chunks, (int64_t) (order * 100 + size * 10 + endian));
+    }
+    ProgressionBar::update (error);
+  }
+
+  /* 2^(1000 CAL_B) does not fit in 1000 cells.  */
+  memset (bytes, 0, sizeof (bytes));
+  bytes[0] = 1;
+  imported = 7;
+  bool error = ops.importBytes (imported, bytes, 125 * CAL_B + 1, 1, 1, 1) || (int) imported != 7;
+  error |= !ops.importBytes (imported, bytes + 1, 125 * CAL_B, 1, 1, 1) || imported.bsr () != 0;
+  if (error) {
+    errorExamples.add (0, (int64_t) 0);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 static bool testCreateInteger (void) {
   IntegerOps ops (11);
   std::string errors = "";
@@ -204,8 +296,8 @@ static bool testDec (void) {
 
     bool carry = ops.dec (bigint);
 
-    int expectedResult = i != -0x3FFFF ? i - 1 : 0;
-    bool error = !(carry == (i == -0x3FFFF) && (int) bigint == expectedResult);
+    const int64_t expectedResult = truncated (i - 1, 3);
+    bool error = !(carry == (expectedResult != i - 1) && (int) bigint == expectedResult);
     if (error) {
       errorExamples.add (i);
     }
@@ -270,6 +362,195 @@ static bool testDiv (void) {
   return !errorExamples.empty ();
 }
 
+/* Checks quotient q and remainder r of a multi-cell division n / d by
+   q d + r = n, |r| < |d| and r having the sign of n.  */
+static bool testDivLarge (void) {
+  Random random;
+  IntegerOps ops (400);
+  IntegerOps ops2 (800);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  Integer numerator = ops2.createInteger ();
+  Integer quotient = ops2.createInteger ();
+  Integer denominator = ops2.createInteger ();
+  Integer check = ops2.createInteger ();
+  Integer absRemainder = ops2.createInteger ();
+  const Integer zero = ops2.createInteger ();
+
+  const int max = 1000;
+  ErrorExamples errorExamples ("Error for: chunksN=%ld, chunksD=%ld.\n");
+  ProgressionBar::init ("IntegerOps::div (Integer&, const Integer&) [large operands]", max);
+  for (int i = 0; i < max; ++i) {
+    int chunksN = CHUNKS (random.nextInt (100) + 1);
+    int chunksD = CHUNKS (random.nextInt (100) + 1);
+    setRandomValue (ops, bigintA, random, chunksN);
+    do {
+      setRandomValue (ops, bigintB, random, chunksD);
+    } while (bigintB == ops.createInteger ());
+    numerator = ops.mul (bigintA, bigintB);
+    setRandomValue (ops2, check, random, random.nextInt (chunksN + chunksD) + 1);
+    ops2.add (numerator, check);
+    quotient = numerator;
+    denominator = bigintB;
+
+    Integer& remainder = ops2.div (quotient, denominator);
+    absRemainder = zero;
+    if (remainder.sign ())
+      ops2.sub (absRemainder, remainder);
+    else
+      ops2.add (absRemainder, remainder);
+    bool error = !(remainder == zero || remainder.sign () == numerator.sign ());
+
+    check = ops2.mul (quotient, denominator);
+    ops2.add (check, remainder);
+    error |= check != numerator;
+
+    if (denominator.sign ()) {
+      check = zero;
+      ops2.sub (check, denominator);
+    } else {
+      check = denominator;
+    }
+    ops2.sub (check, absRemainder);
+    error |= check.sign () || check == zero;
+
+    if (error) {
+      errorExamples.add (chunksN, (int64_t) chunksD);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testDivReciprocal (void) {
+  Random random;
+  IntegerOps ops (2400);
+  Integer numerator = ops.createInteger ();
+  Integer denominator = ops.createInteger ();
+  Integer quotient = ops.createInteger ();
+  Integer expectedQuotient = ops.createInteger ();
+  Integer expectedRemainder = ops.createInteger ();
+
+  const int max = 60;
+  ErrorExamples errorExamples ("Error for: chunksN=%ld, chunksD=%ld.\n");
+  ProgressionBar::init ("IntegerOps::div (Integer&, const Reciprocal&)", max);
+  for (int i = 0; i < max; ++i) {
+    int chunksD = CHUNKS (random.nextInt (300) + 1);
+    do {
+      setRandomValue (ops, denominator, random, chunksD);
+    } while (denominator == ops.createInteger ());
+    const Reciprocal reciprocal = ops.createReciprocal (denominator);
+
+    bool error = false;
+    int chunksN;
+    for (int j = 0; j < 5 && !error; ++j) {
+      chunksN = CHUNKS (random.nextInt (600) + 1);
+      setRandomValue (ops, numerator, random, chunksN);
+      expectedQuotient = numerator;
+      expectedRemainder = ops.div (expectedQuotient, denominator);
+      quotient = numerator;
+      Integer& remainder = ops.div (quotient, reciprocal);
+      error = quotient != expectedQuotient || remainder != expectedRemainder;
+    }
+
+    if (error) {
+      errorExamples.add (chunksN, (int64_t) chunksD);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* The product of the reciprocal and the denominator has one cell more than
+   2 m_size, which is a power of two here.  */
+static bool testDivReciprocalFull (void) {
+  Random random;
+  IntegerOps ops (2048);
+  Integer numerator = ops.createInteger ();
+  Integer denominator = ops.createInteger ();
+  Integer low = ops.createInteger ();
+  Integer quotient = ops.createInteger ();
+  Integer expectedQuotient = ops.createInteger ();
+  Integer expectedRemainder = ops.createInteger ();
+
+  const int max = 4;
+  ErrorExamples errorExamples ("Error for: i=%ld, j=%ld.\n");
+  ProgressionBar::init ("IntegerOps::div (Integer&, const Reciprocal&) [full size]", max);
+  for (int i = 0; i < max; ++i) {
+    denominator = random.nextInt (0x800000) + 0x800000;
+    denominator.shl (2048 * CAL_B - 24);
+    setRandomValue (ops, low, random, CHUNKS (511));
+    ops.add (denominator, low);
+    const Reciprocal reciprocal = ops.createReciprocal (denominator);
+
+    bool error = false;
+    int j;
+    for (j = 0; j < 3 && !error; ++j) {
+      setRandomValue (ops, numerator, random, CHUNKS (512));
+      expectedQuotient = numerator;
+      expectedRemainder = ops.div (expectedQuotient, denominator);
+      quotient = numerator;
+      Integer& remainder = ops.div (quotient, reciprocal);
+      error = quotient != expectedQuotient || remainder != expectedRemainder;
+    }
+
+    if (error) {
+      errorExamples.add (i, (int64_t) j);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testDivmod (void) {
+  Random random;
+  IntegerOps ops (400);
+  Integer numerator = ops.createInteger ();
+  Integer quotient = ops.createInteger ();
+  Integer denominator = ops.createInteger ();
+
+  const int max = 20000;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, value=%ld.\n");
+  ProgressionBar::init ("IntegerOps::divmod (Integer&, uint64_t)", max + 1);
+  for (int i = 0; i < max; ++i) {
+    int chunks = CHUNKS (random.nextInt (100) + 1);
+    setRandomValue (ops, numerator, random, chunks);
+    int64_t value = random.bits (random.nextInt (63) + 1);
+    if (value == 0)
+      value = 1;
+    denominator = value;
+    quotient = numerator;
+    Integer& expectedRemainder = ops.div (quotient, denominator);
+    uint64_t expectedMod = expectedRemainder.sign () ? - (int64_t) expectedRemainder : (int64_t) expectedRemainder;
+
+    Integer result = numerator;
+    bool error = ops.mod (numerator, value) != expectedMod;
+    error |= ops.divmod (result, value) != expectedMod || result != quotient;
+    if (error) {
+      errorExamples.add (chunks, value);
+    }
+    ProgressionBar::update (error);
+  }
+
+  bool error;
+  try {
+    ops.divmod (numerator, 0);
+    error = true;
+  } catch (std::exception& x) {
+    error = strcmp (x.what (), "Division by zero.") != 0;
+  }
+  if (error) {
+    errorExamples.add (0, (int64_t) 0);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 static bool testInc (void) {
   IntegerOps ops (3);
   Integer bigint = ops.createInteger ();
@@ -282,8 +563,8 @@ static bool testInc (void) {
 
     bool carry = ops.inc (bigint);
 
-    int expectedResult = i != 0x3FFFF ? i + 1 : 0;
-    bool error = !(carry == (i == 0x3FFFF) && (int) bigint == expectedResult);
+    const int64_t expectedResult = truncated (i + 1, 3);
+    bool error = !(carry == (expectedResult != i + 1) && (int) bigint == expectedResult);
     if (error) {
       errorExamples.add (i);
     }
@@ -322,6 +603,300 @@ static bool testMul (void) {
   return !errorExamples.empty ();
 }
 
+/* Uses operands large enough for mul to switch to Karatsuba, Toom-3 and
+   Toom-4; the product is checked by dividing it by one of the factors.  */
+static bool testMulLarge (void) {
+  Random random;
+  IntegerOps ops (400);
+  IntegerOps ops2 (800);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  Integer product = ops2.createInteger ();
+  Integer divisor = ops2.createInteger ();
+  Integer expectedQuotient = ops2.createInteger ();
+
+  const int max = 150;
+  ErrorExamples errorExamples ("Error for: chunksA=%ld, chunksB=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mul (const Integer&, const Integer&) [large operands]", max);
+  for (int i = 0; i < max; ++i) {
+    int chunksA = CHUNKS (random.nextInt (100) + 1);
+    int chunksB = CHUNKS (random.nextInt (100) + 1);
+    setRandomValue (ops, bigintA, random, chunksA);
+    do {
+      setRandomValue (ops, bigintB, random, chunksB);
+    } while (bigintB == ops.createInteger ());
+
+    product = ops.mul (bigintA, bigintB);
+    divisor = bigintB;
+    expectedQuotient = bigintA;
+
+    Integer& remainder = ops2.div (product, divisor);
+
+    bool error = !(product == expectedQuotient && (int) remainder == 0);
+    if (error) {
+      errorExamples.add (chunksA, (int64_t) chunksB);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Uses operands large enough for mul to switch to number-theoretic
+   transforms.  */
+static bool testMulHuge (void) {
+  Random random;
+  IntegerOps ops (2900);
+  IntegerOps ops2 (5800);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  Integer product = ops2.createInteger ();
+  Integer divisor = ops2.createInteger ();
+  Integer expectedQuotient = ops2.createInteger ();
+
+  const int max = 6;
+  ErrorExamples errorExamples ("Error for: chunksA=%ld, chunksB=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mul (const Integer&, const Integer&) [huge operands]", max);
+  for (int i = 0; i < max; ++i) {
+    int chunksA = CHUNKS (random.nextInt (180) + 520);
+    int chunksB = CHUNKS (random.nextInt (180) + 520);
+    setRandomValue (ops, bigintA, random, chunksA);
+    setRandomValue (ops, bigintB, random, chunksB);
+
+    product = ops.mul (bigintA, bigintB);
+    divisor = bigintB;
+    expectedQuotient = bigintA;
+
+    Integer& remainder = ops2.div (product, divisor);
+
+    bool error = !(product == expectedQuotient && (int) remainder == 0);
+    if (error) {
+      errorExamples.add (chunksA, (int64_t) chunksB);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Compares products and squares spread over threads with those computed in
+   this thread only.  */
+static bool testMulParallel (void) {
+  Random random;
+  IntegerOps ops (6000);
+  IntegerOps serialOps (6000);
+  ops.setThreads (4);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+
+  const int max = 4;
+  ErrorExamples errorExamples ("Error for: chunksA=%ld, chunksB=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mul (const Integer&, const Integer&) [threads]", max);
+  for (int i = 0; i < max; ++i) {
+    int chunksA = CHUNKS (random.nextInt (300) + 1100);
+    int chunksB = CHUNKS (random.nextInt (300) + 1100);
+    setRandomValue (ops, bigintA, random, chunksA);
+    setRandomValue (ops, bigintB, random, chunksB);
+
+    bool error = ops.mul (bigintA, bigintB) != serialOps.mul (bigintA, bigintB);
+    error |= ops.sqr (bigintA) != serialOps.sqr (bigintA);
+    if (error) {
+      errorExamples.add (chunksA, (int64_t) chunksB);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testParse (void) {
+  Random random;
+  IntegerOps ops (1000);
+  Integer bigint = ops.createInteger ();
+  Integer parsed = ops.createInteger ();
+
+  const int max = 400;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, variant=%ld.\n");
+  ProgressionBar::init ("IntegerOps::parse (const char*, size_t, Integer&)", max + 1);
+  for (int i = 0; i < max; ++i) {
+    const int chunks = CHUNKS (random.nextInt (100) + 1);
+    setRandomValue (ops, bigint, random, chunks);
+    std::string str = ops.toString (bigint);
+    const int variant = random.nextInt (4);
+    bool valid = true;
+    if (variant == 1) {
+      str.insert (str[0] == '-', random.nextInt (30), '0');
+    } else if (variant == 2 && str[0] != '-') {
+      str.insert (0, 1, '+');
+    } else if (variant == 3) {
+      const char invalid[] = {'a', ' ', '/', ':', '-', '.'};
+      str.insert (random.nextInt (str.length ()) + 1, 1, invalid[random.nextInt (6)]);
+      valid = false;
+    }
+
+    parsed = 7;
+    bool error;
+    if (valid)
+      error = !ops.parse (str.c_str (), str.length (), parsed) || parsed != bigint;
+    else
+      error = ops.parse (str.c_str (), str.length (), parsed) || (int) parsed != 7;
+    if (error) {
+      errorExamples.add (chunks, (int64_t) variant);
+    }
+    ProgressionBar::update (error);
+  }
+
+  /* 10 * 2^(1000 CAL_B - 1) does not fit in 1000 cells.  */
+  bigint = 1;
+  bigint.shl (1000 * CAL_B - 1);
+  std::string str = ops.toString (bigint) + "0";
+  bool error = ops.parse (str.c_str (), str.length (), parsed) || ops.parse ("", 0, parsed) || ops.parse ("-", 1, parsed);
+  try {
+    ops.fromString ("12x");
+    error = true;
+  } catch (std::invalid_argument& x) {
+  }
+  error |= ops.fromString ("-000123456789012345678901234567890") != ops.fromString ("-123456789012345678901234567890");
+
+  /* Long strings create the decimal powers, which must leave a product
+     alone.  */
+  IntegerOps fresh (2000);
+  Integer& product = fresh.mul (fresh.createInteger (123456789), fresh.createInteger (1000));
+  const std::string nines (3000, '9');
+  Integer large = fresh.fromString (nines);
+  error |= fresh.toString (product) != "123456789000" || fresh.toString (large) != nines;
+  if (error) {
+    errorExamples.add (0, (int64_t) 0);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testRadix (void) {
+  Random random;
+  IntegerOps ops (1000);
+  Integer bigint = ops.createInteger ();
+  Integer value = ops.createInteger ();
+  Integer parsed = ops.createInteger ();
+  const char* digitChars[] = {"0123456789abcdefghijklmnopqrstuv", "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+
+  const int max = 600;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, bits=%ld.\n");
+  ProgressionBar::init ("IntegerOps::toRadix (char*, const Integer&, int)", max + 1);
+  for (int i = 0; i < max; ++i) {
+    const int chunks = random.nextInt (250);
+    const int bits = random.nextInt (6) + 1;
+    setRandomValue (ops, bigint, random, chunks);
+
+    /* Expected digits, from repeated division by 2^bits.  */
+    std::string expected;
+    value = bigint;
+    do {
+      expected.insert (0, 1, digitChars[bits == 6][ops.divmod (value, 1 << bits)]);
+    } while (value.bsr () > 0);
+    if (bigint.sign ()) {
+      expected.insert (0, 1, '-');
+    }
+
+    const size_t length = ops.radixLength (bigint, bits);
+    std::string str (length + 1, '#');
+    bool error = ops.toRadix (&str[0], bigint, bits) != length || str[length] != '#' || str.compare (0, length, expected) != 0;
+    if (bits == 4) {
+      error |= ops.toHex (bigint) != expected;
+    }
+    parsed = 7;
+    error |= !ops.fromRadix (expected.c_str (), expected.length (), bits, parsed) || parsed != bigint;
+    if (error) {
+      errorExamples.add (chunks, (int64_t) bits);
+    }
+    ProgressionBar::update (error);
+  }
+
+  parsed = 7;
+  bool error = !ops.fromHex ("-00FfA0", 7, parsed) || (int) parsed != -0xFFA0 || ops.toHex (parsed) != "-ffa0";
+  error |= ops.fromHex ("12g", 3, parsed) || ops.fromHex ("", 0, parsed) || ops.fromRadix ("2", 1, 1, parsed) || (int) parsed != -0xFFA0;
+  /* 2^(1000 CAL_B) does not fit in 1000 cells.  */
+  std::string str (250 * CAL_B + 1, '0');
+  str[0] = '1';
+  error |= ops.fromHex (str.c_str (), str.length (), parsed);
+  if (error) {
+    errorExamples.add (0, (int64_t) 0);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Compares the square with the product of two distinct but equal operands,
+   for sizes from the schoolbook method up to number-theoretic transforms.  */
+static bool testSqr (void) {
+  Random random;
+  IntegerOps ops (2500);
+  IntegerOps ops2 (5000);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  Integer expectedSquare = ops2.createInteger ();
+
+  const int max = 100;
+  ErrorExamples errorExamples ("Error for: chunks=%ld.\n");
+  ProgressionBar::init ("IntegerOps::sqr (const Integer&)", max);
+  for (int i = 0; i < max; ++i) {
+    int chunks = CHUNKS (i < max / 10 ? random.nextInt (100) + 520 : random.nextInt (520) + 1);
+    setRandomValue (ops, bigintA, random, chunks);
+    bigintB = bigintA;
+
+    expectedSquare = ops.mul (bigintA, bigintB);
+    bool error = !(ops.sqr (bigintA) == expectedSquare && ops.mul (bigintA, bigintA) == expectedSquare);
+    if (error) {
+      errorExamples.add (chunks);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testMulWord (void) {
+  Random random;
+  IntegerOps ops (400);
+  Integer factor = ops.createInteger ();
+  Integer valueAsInteger = ops.createInteger ();
+  Integer result = ops.createInteger ();
+
+  const int max = 20000;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, value=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mulWord (Integer&, uint64_t)", max + 1);
+  for (int i = 0; i < max; ++i) {
+    int chunks = CHUNKS (random.nextInt (97) + 1);
+    setRandomValue (ops, factor, random, chunks);
+    int64_t value = random.bits (random.nextInt (64));
+    valueAsInteger = value;
+
+    result = factor;
+    bool error = ops.mulWord (result, value);
+    error |= result != ops.mul (factor, valueAsInteger);
+    if (error) {
+      errorExamples.add (chunks, value);
+    }
+    ProgressionBar::update (error);
+  }
+
+  /* 2^(400 CAL_B - 1) * 2 does not fit in 400 cells.  */
+  result = 1;
+  result.shl (400 * CAL_B - 1);
+  bool error = !ops.mulWord (result, 2) || result != ops.createInteger ();
+  if (error) {
+    errorExamples.add (0, (int64_t) 2);
+  }
+  ProgressionBar::update (error);
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 static bool testSub (void) {
   Random random;
   IntegerOps ops (4);
@@ -337,20 +912,8 @@ static bool testSub (void) {
     bigintA = valA;
     bigintB = valB;
 
-    bool expectedCarry;
-    int64_t expectedDiff = valA - valB;
-    if (expectedDiff > 0xFFFFFF) {
-      expectedDiff &= 0xFFFFFF;
-      expectedCarry = true;
-    } else if (expectedDiff == -0x1000000) {
-      expectedDiff = 0;
-      expectedCarry = true;
-    } else if (expectedDiff < -0x1000000) {
-      expectedDiff |= 0x1000000;
-      expectedCarry = true;
-    } else {
-      expectedCarry = false;
-    }
+    const int64_t expectedDiff = truncated (valA - valB, 4);
+    const bool expectedCarry = expectedDiff != valA - valB;
 
     bool carry = ops.sub (bigintA, bigintB);
 
@@ -383,6 +946,156 @@ static bool testSub (void) {
   return !errorExamples.empty ();
 }
 
+static bool testView (void) {
+  Random random;
+  IntegerOps ops (400);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  Integer expected = ops.createInteger ();
+  Integer actual = ops.createInteger ();
+
+  /* The operands are copied into one arena, after some leading zero cells,
+     and used through views; the results go to an Integer using the arena
+     too.  */
+  uint64_t arena[1300] = {0};
+  uint64_t* cellsA = arena;
+  uint64_t* cellsB = arena + 450;
+  Integer external (arena + 900, 400);
+
+  const int max = 400;
+  ErrorExamples errorExamples ("Error for: chunksA=%ld, chunksB=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mul (const IntegerView&, const IntegerView&) [views]", max);
+  for (int i = 0; i < max; ++i) {
+    const int chunksA = CHUNKS (random.nextInt (100));
+    const int chunksB = CHUNKS (random.nextInt (50));
+    setRandomValue (ops, bigintA, random, chunksA);
+    setRandomValue (ops, bigintB, random, chunksB);
+    memset (arena, 0, sizeof (arena) - 400 * 8);
+    memcpy (cellsA, bigintA.buf (), bigintA.max () << 3);
+    memcpy (cellsB, bigintB.buf (), bigintB.max () << 3);
+    const IntegerView viewA (cellsA, bigintA.max () + 3, bigintA.sign ());
+    const IntegerView viewB (cellsB, bigintB.max () + 40, bigintB.sign ());
+
+    bool error = viewA.max () != bigintA.max () || viewA.bsr () != bigintA.bsr ();
+    const Integer product = ops.mul (bigintA, bigintB);
+    error |= ops.mul (viewA, viewB) != product;
+    const Integer square = ops.sqr (bigintA);
+    error |= ops.mul (viewA, viewA) != square;
+
+    expected = bigintB;
+    external = bigintB;
+    ops.add (expected, bigintA);
+    ops.add (external, viewA);
+    error |= external != expected;
+    ops.sub (expected, bigintA);
+    ops.sub (external, viewA);
+    error |= external != expected || external != bigintB;
+
+    if (bigintB.max () > 0) {
+      expected = bigintA;
+      external = viewA;
+      actual = ops.div (expected, bigintB);
+      error |= ops.div (external, viewB) != actual || external != expected;
+      error |= ops.mod (viewA, 1000003) != ops.mod (bigintA, 1000003);
+    }
+    error |= ops.toString (viewA) != ops.toString (bigintA);
+
+    /* The destination wrote its cells in place.  */
+    error |= IntegerView (arena + 900, 400, external.sign ()).max () != external.max ();
+    if (error) {
+      errorExamples.add ((int64_t) chunksA, (int64_t) chunksB);
+    }
+    ProgressionBar::update (error);
+  }
+
+  /* A value of more cells than there are is rejected, by copy, by move and
+     through a view, and the cells stay in use; an Integer of its own grows.  */
+  Integer small (arena, 4);
+  bigintA = 1;
+  bigintA.shl (4 * CAL_B);
+  int rejected = 0;
+  try {
+    small = bigintA;
+  } catch (std::length_error& x) {
+    ++rejected;
+  }
+  try {
+    small = Integer (bigintA);
+  } catch (std::length_error& x) {
+    ++rejected;
+  }
+  try {
+    small = IntegerView (bigintA);
+  } catch (std::length_error& x) {
+    ++rejected;
+  }
+  small = 7;
+  Integer grown (4);
+  grown = IntegerView (bigintA);
+  if (rejected != 3 || small.buf () != arena || arena[0] != 7 || grown != bigintA) {
+    errorExamples.add (-1, (int64_t) rejected);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testToChars (void) {
+  Random random;
+  IntegerOps ops (1000);
+  Integer bigint = ops.createInteger ();
+  Integer power = ops.createInteger (1);
+
+  const int max = 400;
+  ErrorExamples errorExamples ("Error for: chunks=%ld, variant=%ld.\n");
+  ProgressionBar::init ("IntegerOps::toChars (char*, char*, const Integer&)", max);
+  for (int i = 0; i < max; ++i) {
+    /* Powers of ten and their neighbours are those whose length is hardest
+       to tell beforehand.  */
+    const int chunks = random.nextInt (100);
+    const int variant = random.nextInt (3);
+    std::string expected;
+    if (variant == 0) {
+      setRandomValue (ops, bigint, random, chunks);
+      expected = ops.toString (bigint);
+    } else {
+      power = 1;
+      for (int j = 0; j < 7 * chunks; ++j) {
+        ops.mulWord (power, 10);
+      }
+      bigint = power;
+      expected = "1" + std::string (7 * chunks, '0');
+      if (variant == 2 && chunks > 0) {
+        ops.dec (bigint);
+        expected = std::string (7 * chunks, '9');
+      }
+    }
+
+    const size_t length = expected.length ();
+    std::string str (length + 1, '#');
+    bool error = ops.decimalLength (bigint) != length || ops.toChars (nullptr, nullptr, bigint) != length;
+    error |= ops.toChars (&str[0], &str[0] + length - 1, bigint) != length || str[0] != '#';
+    error |= ops.toChars (&str[0], &str[0] + length + 1, bigint) != length || str.compare (0, length, expected) != 0 || str[length] != '#';
+    if (i % 20 == 0) {
+      FILE* file = tmpfile ();
+      error |= !ops.write (file, bigint);
+      rewind (file);
+      str.assign (length + 1, '#');
+      error |= fread (&str[0], 1, length + 1, file) != length || str.compare (0, length, expected) != 0;
+      fclose (file);
+      std::ostringstream stream;
+      error |= !ops.write (stream, bigint) || stream.str () != expected;
+    }
+    if (error) {
+      errorExamples.add (chunks, (int64_t) variant);
+    }
+    ProgressionBar::update (error);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 static bool testToString (void) {
   Random random;
   IntegerOps ops (88);
@@ -427,6 +1140,57 @@ static bool testToString (void) {
   return errors.length () > 0;
 }
 
+static bool testToStringLarge (void) {
+  Random random;
+  IntegerOps ops (1000);
+  Integer bigint = ops.createInteger ();
+
+  const int max = 400;
+  ErrorExamples errorExamples ("Error for: digits=%ld, sign=%ld.\n");
+  ProgressionBar::init ("IntegerOps::toString(const Integer&) [large values]", max);
+  for (int i = 0; i < max; ++i) {
+    /* Digit strings of up to 1800 digits, often with long runs of zeros or
+       nines, built up in chunks of 9 digits.  */
+    const int chunks = random.nextInt (200) + 1;
+    const int kind = random.nextInt (3);
+    std::string expected;
+    bigint = 0;
+    for (int j = 0; j < chunks; ++j) {
+      int chunk = kind == 0 || random.nextInt (4) > 0 ? random.nextInt (1000000000) : kind == 1 ? 0 : 999999999;
+      if (j == 0 && chunk == 0)
+        chunk = 1;
+      ops.mulWord (bigint, 1000000000);
+      ops.add (bigint, chunk);
+      std::string digits = std::to_string (chunk);
+      if (j > 0)
+        expected.append (9 - digits.length (), '0');
+      expected += digits;
+    }
+    const bool sign = random.nextInt (2) == 1;
+    if (sign) {
+      Integer value = bigint;
+      bigint = 0;
+      ops.sub (bigint, value);
+      expected = "-" + expected;
+    }
+
+    bool error = ops.toString (bigint) != expected;
+
+    /* A product converted by an IntegerOps that has yet to create its
+       decimal powers.  */
+    if (i % 10 == 0) {
+      IntegerOps fresh (1000);
+      error |= fresh.toString (fresh.mul (bigint, fresh.createInteger (1))) != expected;
+    }
+    if (error) {
+      errorExamples.add (expected.length (), (int64_t) sign);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 const test_fn_t integerOpsTests[] = {
   testCreateInteger,
   testInc,
@@ -435,6 +1199,22 @@ const test_fn_t integerOpsTests[] = {
   testAddInt,
   testSub,
   testMul,
+  testMulLarge,
+  testMulHuge,
+  testMulParallel,
+  testSqr,
+  testMulWord,
   testDiv,
-  testToString
+  testDivLarge,
+  testDivReciprocal,
+  testDivReciprocalFull,
+  testDivmod,
+  testParse,
+  testToString,
+  testToStringLarge,
+  testRadix,
+  testToChars,
+  testBytes,
+  testView,
+  testBatch
 };
@@ -24,10 +24,11 @@
 #include <skylge/testutils/ErrorExamples.h>
 #include <skylge/testutils/progressionBar.h>
 #include <skylge/testutils/Random.h>
+#include "common.h"
 #include "integerTests.h"
 
 /* bigint.m_size should be 11.  */
-static bool areEqual (const Integer& bigint, const int* array, bool sign) {
+static bool areEqual (const Integer& bigint, const uint64_t* array, bool sign) {
   if (bigint.size () != 11) {
     printf ("integerTests.cpp: areEqual: bigint not of expected size.\n");
     exit (EXIT_FAILURE);
@@ -71,11 +72,16 @@ static int bsr (int value) {
   }
 }
 
-static int* setValue (int* dst, int64_t value) {
+static uint64_t* setValue (uint64_t* dst, int64_t value) {
   uint64_t val = value < 0 ? -value : value;
   for (int i = 0; i < 11; ++i) {
-    dst[i] = val & 0x3F;
-    val >>= 6;
+#if CAL_B < 64
+    dst[i] = val & ((uint64_t) 1 << CAL_B) - 1;
+    val >>= CAL_B;
+#else
+    dst[i] = val;
+    val = 0;
+#endif
   }
   return dst;
 }
@@ -98,13 +104,12 @@ static bool testAbsAdd (void) {
         bigintA = signA * valA;
         bigintB = signB * valB;
 
-        int expectedSum = valA + valB;
-        bool expectedCarry = (expectedSum & 0x40000000) != 0;
-        expectedSum = signA * (expectedSum & 0x3FFFFFFF);
+        const int64_t expectedSum = signA * truncated (valA + valB, 5);
+        const bool expectedCarry = truncated (valA + valB, 5) != valA + valB;
 
         bool carry = bigintA.absAdd (bigintB);
 
-        bool error = !(carry == expectedCarry && (int) bigintA == expectedSum);
+        bool error = !(carry == expectedCarry && (int64_t) bigintA == expectedSum);
         if (error) {
           errorExamples.add (signA * valA, valA, signB * valB, valB);
         }
@@ -132,13 +137,12 @@ static bool testAbsAddInt (void) {
         int signA = (k & 1) != 0 ? -1 : 1;
         bigint = signA * valA;
 
-        int expectedSum = valA + j;
-        bool expectedCarry = (expectedSum & 0x40000000) != 0;
-        expectedSum = signA * (expectedSum & 0x3FFFFFFF);
+        const int64_t expectedSum = signA * truncated (valA + j, 5);
+        const bool expectedCarry = truncated (valA + j, 5) != valA + j;
 
         bool carry = bigint.absAdd (j);
 
-        bool error = !(carry == expectedCarry && (int) bigint == expectedSum);
+        bool error = !(carry == expectedCarry && (int64_t) bigint == expectedSum);
         if (error) {
           errorExamples.add (signA * valA, valA, (int64_t) j);
         }
@@ -151,13 +155,12 @@ static bool testAbsAddInt (void) {
     int signA = (i & 1) != 0 ? -1 : 1;
     bigint = signA * valA;
 
-    int expectedSum = valA + i;
-    bool expectedCarry = (expectedSum & 0x40000000) != 0;
-    expectedSum = signA * (expectedSum & 0x3FFFFFFF);
+    const int64_t expectedSum = signA * truncated (valA + i, 5);
+    const bool expectedCarry = truncated (valA + i, 5) != valA + i;
 
     bool carry = bigint.absAdd (i);
 
-    bool error = !(carry == expectedCarry && (int) bigint == expectedSum);
+    bool error = !(carry == expectedCarry && (int64_t) bigint == expectedSum);
     if (error) {
       errorExamples.add (signA * valA, valA, (int64_t) i);
     }
@@ -202,11 +205,12 @@ static bool testAbsInc (void) {
       bigint = s ? -i : i;
 
       bool carry = bigint.absInc ();
-      int expectedResult = i + 1 & 0x3FFFF;
+      int expectedResult = truncated (i + 1, 3);
+      const bool expectedCarry = expectedResult != i + 1;
       if (s && expectedResult != 1)
         expectedResult = -expectedResult;
 
-      bool error = !(carry == (i == 0x3FFFF) && (int) bigint == expectedResult);
+      bool error = !(carry == expectedCarry && (int) bigint == expectedResult);
       if (error) {
         errorExamples.add (s ? -i : i);
       }
@@ -288,7 +292,7 @@ static bool testAbsSubInt (void) {
 static bool testAssign (void) {
   Random random;
   Integer bigint (11);
-  int array[11];
+  uint64_t array[11];
 
   const int max = 0x3FFFFC;
   ErrorExamples errorExamples ("Error for: %ld\n");
@@ -392,9 +396,10 @@ static bool testCopy (void) {
   }
   ProgressionBar::update (error);
 
-  /* Test assigment of a number too large for the original buffer.  */
-  val = 1000000000000000000;
-  bigintB = val;
+  /* Test assigment of a number too large for the original buffer, 2^val.  */
+  val = 4 * CAL_B;
+  bigintB = 1;
+  bigintB.shl (val);
   bigintA = bigintB;
   error = !(bigintA == bigintB && bigintA.size () == 11 && bigintA.buf () != originalBuffer && bigintA.buf () != bigintB.buf ());
   if (error) {
@@ -474,6 +479,42 @@ static bool testGetBit (void) {
   return !errorExamples.empty ();
 }
 
+static bool isInline (const Integer& bigint) {
+  const char* buffer = (const char*) bigint.buf ();
+  return buffer >= (const char*) &bigint && buffer < (const char*) (&bigint + 1);
+}
+
+static bool testInline (void) {
+  Random random;
+
+  const int max = 0x10000;
+  ErrorExamples errorExamples ("Error for: size=%ld, val=%ld\n");
+  ProgressionBar::init ("Integer::Integer (int) [inline cells]", max);
+  for (int i = 0; i < max; ++i) {
+    const int size = 2 + i % 5;
+    const int bits = CAL_B * size < 62 ? CAL_B * size : 62;
+    const int64_t val = random.bits (bits) - ((int64_t) 1 << bits - 1);
+    Integer bigint (size);
+    bigint = val;
+
+    Integer copied (bigint);
+    bool error = isInline (bigint) != size <= INTEGER_INLINE_SIZE;
+    error |= !(copied == bigint) || copied.buf () == bigint.buf ();
+
+    Integer* moved = new Integer (std::move (copied));
+    Integer other (size == 2 ? 5 : 2);
+    other = std::move (*moved);
+    delete moved;
+    error |= (int64_t) other != val || other.buf () == bigint.buf ();
+    if (error) {
+      errorExamples.add ((int64_t) size, val);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
 static bool testInequal (void) {
   Random random;
   Integer bigintA (4);
@@ -534,12 +575,13 @@ static bool testLshl (void) {
     bigintH = valH;
     bigintL = valL;
 
+    /* H and L together form a value of 10 cells.  */
     bigintH.lshl (bigintL, x);
-    int64_t expected = val << x & 0xFFFFFFFFFFFFFFF;
-    int expectedH = expected >> 30;
-    int expectedL = expected & 0x3FFFFFFF;
+    const int64_t shiftedL = (int64_t) valL << x;
+    const int64_t expectedL = truncated (shiftedL, 5);
+    const int64_t expectedH = truncated ((int64_t) valH << x | (shiftedL - expectedL) >> (5 * CAL_B < 63 ? 5 * CAL_B : 0), 5);
 
-    bool error = !((int) bigintH == expectedH && (int) bigintL == expectedL);
+    bool error = !((int64_t) bigintH == expectedH && (int64_t) bigintL == expectedL);
     if (error) {
       errorExamples.add (valH, (int64_t) valL, (int64_t) x);
     }
@@ -581,14 +623,16 @@ static bool testMove (void) {
   }
   ProgressionBar::update (error);
 
-  /* Test assigment of a number too large for the original buffer.  */
-  val = 1000000000000000000;
-  bigintB = new Integer (11);
+  /* Test assigment of a number too large for the original buffer, 2^val.  */
+  val = 4 * CAL_B;
+  Integer expected (11);
+  expected = 1;
+  expected.shl (val);
+  bigintB = new Integer (expected);
   const uint64_t* bufB = bigintB->buf ();
-  *bigintB = val;
   bigintA = std::move (*bigintB);
   delete bigintB;
-  error = !(val == (int64_t) bigintA && bigintA.size () == 11 && bigintA.buf () != originalBuffer && bigintA.buf () == bufB);
+  error = !(bigintA == expected && bigintA.size () == 11 && bigintA.buf () != originalBuffer && bigintA.buf () == bufB);
   if (error) {
     errorExamples.add (val);
   }
@@ -635,9 +679,9 @@ static bool testShl (void) {
     bigint = val;
 
     bigint.shl (x);
-    int expected = val << x & 0x3FFFFFFF;
+    const int64_t expected = truncated ((int64_t) val << x, 5);
 
-    bool error = (int) bigint != expected;
+    bool error = (int64_t) bigint != expected;
     if (error) {
       errorExamples.add (val, (int64_t) x);
     }
@@ -793,5 +837,6 @@ const test_fn_t integerTests[] = {
   testAbsAdd,
   testAbsSub,
   testAbsAddInt,
-  testAbsSubInt
+  testAbsSubInt,
+  testInline
 };
@@ -0,0 +1,153 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <skylge/math/SharedIntegerOps.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "common.h"
+#include "sharedIntegerOpsTests.h"
+
+static bool testResults (void) {
+  Random random;
+  SharedIntegerOps ops (200);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+
+  const int max = 1000;
+  ErrorExamples errorExamples ("Error for: chunksA=%ld, chunksB=%ld.\n");
+  ProgressionBar::init ("SharedIntegerOps::mul (const IntegerView&, const IntegerView&)", max);
+  for (int i = 0; i < max; ++i) {
+    const int chunksA = random.nextInt (25);
+    const int chunksB = 1 + random.nextInt (24);
+    setRandomValue (ops.local (), bigintA, random, chunksA);
+    setRandomValue (ops.local (), bigintB, random, chunksB);
+
+    /* The results stay valid when the next operation is done.  */
+    const Integer product = ops.mul (bigintA, bigintB);
+    const Integer square = ops.sqr (bigintB);
+    Integer quotient = bigintA;
+    const Integer remainder = ops.div (quotient, bigintB);
+    bool error = &ops.local () != &ops.local ();
+    error |= product.size () != (product.max () > 2 ? product.max () : 2);
+    error |= ops.local ().mul (bigintA, bigintB) != product || ops.local ().sqr (bigintB) != square;
+
+    Integer value = ops.createInteger ();
+    value = ops.mul (quotient, bigintB);
+    ops.add (value, remainder);
+    error |= value != bigintA;
+    error |= ops.fromString (ops.toString (bigintA)) != bigintA;
+    if (error) {
+      errorExamples.add ((int64_t) chunksA, (int64_t) chunksB);
+    }
+    ProgressionBar::update (error);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+static bool testThreads (void) {
+  const int threadCount = 8;
+  const int max = 300;
+  SharedIntegerOps ops (200);
+  SharedIntegerOps smallOps (20);
+  std::atomic<int> errors[threadCount];
+  ErrorExamples errorExamples ("Error for: thread=%ld.\n");
+  ProgressionBar::init ("SharedIntegerOps::local (void) [threads]", threadCount);
+
+  /* All threads use the same two objects, for two sizes.  */
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) {
+    errors[t] = 0;
+    threads.emplace_back ([t, &ops, &smallOps, &errors] () {
+      Random random;
+      Integer bigintA = ops.createInteger ();
+      Integer bigintB = ops.createInteger ();
+      Integer small = smallOps.createInteger ();
+      for (int i = 0; i < max; ++i) {
+        setRandomValue (ops.local (), bigintA, random, random.nextInt (25));
+        setRandomValue (ops.local (), bigintB, random, 1 + random.nextInt (24));
+        setRandomValue (smallOps.local (), small, random, 1 + random.nextInt (4));
+
+        const Integer product = ops.mul (bigintA, bigintB);
+        const std::string digits = smallOps.toString (small);
+        Integer quotient = ops.createInteger ();
+        quotient = product;
+        const Integer remainder = ops.div (quotient, bigintB);
+        if (quotient != bigintA || remainder.bsr () != 0 || smallOps.fromString (digits) != small)
+          ++errors[t];
+      }
+    });
+  }
+  for (int t = 0; t < threadCount; ++t) {
+    threads[t].join ();
+  }
+
+  for (int t = 0; t < threadCount; ++t) {
+    bool error = errors[t].load () != 0;
+    if (error) {
+      errorExamples.add ((int64_t) t);
+    }
+    ProgressionBar::update (error);
+  }
+
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* The IntegerOps of a thread, whose Integers come from the allocator in
+   use, are deleted when the thread exits or, if it has not, when the
+   object is destroyed.  */
+static bool testRelease (void) {
+  CountingAllocator allocator;
+  ProgressionBar::init ("SharedIntegerOps::~SharedIntegerOps (void)", 2);
+  IntegerAllocator::set (&allocator);
+  bool threadError;
+  {
+    SharedIntegerOps ops (200);
+    Integer bigint = ops.createInteger (12345);
+    std::thread thread ([&ops, &bigint] () {
+      ops.sqr (bigint);
+    });
+    thread.join ();
+    threadError = allocator.allocated != allocator.released + 1;
+    ProgressionBar::update (threadError);
+
+    ops.sqr (bigint);
+  }
+  IntegerAllocator::set (NULL);
+  const bool error = allocator.allocated != allocator.released;
+  ProgressionBar::update (error);
+
+  if (threadError || error)
+    printf ("IntegerOps not deleted (allocated: %d, released: %d).\n", allocator.allocated, allocator.released);
+  return threadError || error;
+}
+
+const test_fn_t sharedIntegerOpsTests[] = {
+  testResults,
+  testThreads,
+  testRelease
+};
@@ -18,11 +18,19 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include <skylge/testutils/testRunner.h>
+#include "cellOpsTests.h"
+#include "integerAllocatorTests.h"
+#include "integerFileTests.h"
 #include "integerOpsTests.h"
 #include "integerTests.h"
+#include "sharedIntegerOpsTests.h"
 
 int main (int argc, char** args, char** env) {
   RUN_TESTS (integerTests);
   RUN_TESTS (integerOpsTests);
+  RUN_TESTS (integerFileTests);
+  RUN_TESTS (integerAllocatorTests);
+  RUN_TESTS (sharedIntegerOpsTests);
+  RUN_TESTS (cellOpsTests);
   return 0;
 }
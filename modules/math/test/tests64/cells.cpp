@@ -0,0 +1,43 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "cells.h"
+
+void referenceMul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn) {
+  for (int i = 0; i < an + bn; ++i) {
+    dst[i] = 0;
+  }
+  for (int j = 0; j < bn; ++j) {
+    uint64_t high = 0;
+    for (int i = 0; i < an; ++i) {
+      const unsigned __int128 t = (unsigned __int128) a[i] * b[j] + dst[i + j] + high;
+      dst[i + j] = (uint64_t) t;
+      high = (uint64_t) (t >> 64);
+    }
+    dst[an + j] = high;
+  }
+}
+
+void setRandomCells (uint64_t* dst, Random& random, int n) {
+  const int kind = random.nextInt (3);
+  for (int i = 0; i < n; ++i) {
+    const int cellKind = kind == 0 ? 2 : random.nextInt (4);
+    dst[i] = cellKind == 0 ? 0 : cellKind == 1 ? (uint64_t) -1 : (uint64_t) random.bits (64);
+  }
+}
@@ -0,0 +1,34 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef CELLS_INCLUDED
+#define CELLS_INCLUDED
+
+#include <stdint.h>
+#include <skylge/testutils/Random.h>
+
+/* dst[0..an+bn) = a * b, cell by cell in 128 bit arithmetic, as reference
+   for the kernels.  */
+void referenceMul (uint64_t* dst, const uint64_t* a, int an, const uint64_t* b, int bn);
+
+/* Sets dst[0..n) to random cells, many of them all zeros or all ones so
+   that long carry chains occur.  */
+void setRandomCells (uint64_t* dst, Random& random, int n);
+
+#endif
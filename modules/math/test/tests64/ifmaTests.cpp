@@ -0,0 +1,191 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <string.h>
+#include <skylge/math/IntegerOps.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "cells.h"
+#include "ifma.h"
+#include "ifmaTests.h"
+#include "limbs.h"
+
+#define MAX_CELLS (3 * IFMA_MAX_CELLS + 8)
+
+/* Returns false, after saying so, if the processor does not support IFMA,
+   in which case the kernels cannot be run.  */
+static bool ifmaAvailable (void) {
+  if (Ifma::setActive (true))
+    return true;
+  printf ("The processor does not support IFMA; skipped.\n");
+  return false;
+}
+
+/* Compares Ifma::mul with the reference, for a of up to three blocks of
+   IFMA_MAX_CELLS cells, so that the blocks are added up.  */
+static bool testMul (void) {
+  Random random;
+  uint64_t a[MAX_CELLS];
+  uint64_t b[IFMA_MAX_CELLS];
+  uint64_t dst[MAX_CELLS + IFMA_MAX_CELLS];
+  uint64_t expected[MAX_CELLS + IFMA_MAX_CELLS];
+
+  const int max = 4000;
+  ErrorExamples errorExamples ("Error for: an=%ld, bn=%ld.\n");
+  ProgressionBar::init ("Ifma::mul", max);
+  if (!ifmaAvailable ())
+    return false;
+  for (int i = 0; i < max; ++i) {
+    const int an = random.nextInt (MAX_CELLS) + 1;
+    const int bn = i < 64 ? i + 1 : random.nextInt (IFMA_MAX_CELLS) + 1;
+    setRandomCells (a, random, an);
+    setRandomCells (b, random, bn);
+
+    Ifma::mul (dst, a, an, b, bn);
+    referenceMul (expected, a, an, b, bn);
+    bool error = memcmp (dst, expected, an + bn << 3) != 0;
+    if (error) {
+      errorExamples.add (an, (int64_t) bn);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Compares Limbs::mulBasecase with IFMA against the reference and against
+   mulBasecase without it, with either operand the longer one and beyond
+   IFMA_MAX_CELLS, so that the operands are swapped and split.  */
+static bool testMulBasecase (void) {
+  Random random;
+  uint64_t a[MAX_CELLS];
+  uint64_t b[MAX_CELLS];
+  uint64_t dst[2 * MAX_CELLS];
+  uint64_t scalar[2 * MAX_CELLS];
+  uint64_t expected[2 * MAX_CELLS];
+
+  const int max = 4000;
+  ErrorExamples errorExamples ("Error for: an=%ld, bn=%ld.\n");
+  ProgressionBar::init ("Limbs::mulBasecase [IFMA]", max);
+  if (!ifmaAvailable ())
+    return false;
+  for (int i = 0; i < max; ++i) {
+    const int shortLength = random.nextInt (IFMA_MAX_CELLS) + 1;
+    const int longLength = random.nextInt (MAX_CELLS) + 1;
+    const bool swap = random.nextInt (2) == 1;
+    const int an = swap ? shortLength : longLength;
+    const int bn = swap ? longLength : shortLength;
+    setRandomCells (a, random, an);
+    setRandomCells (b, random, bn);
+
+    Ifma::setActive (true);
+    Limbs::mulBasecase (dst, a, an, b, bn);
+    Ifma::setActive (false);
+    Limbs::mulBasecase (scalar, a, an, b, bn);
+    referenceMul (expected, a, an, b, bn);
+    bool error = memcmp (dst, expected, an + bn << 3) != 0 || memcmp (scalar, expected, an + bn << 3) != 0;
+    if (error) {
+      errorExamples.add (an, (int64_t) bn);
+    }
+    ProgressionBar::update (error);
+  }
+  Ifma::setActive (true);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Compares Ifma::sqr with the reference and with Limbs::sqrBasecase
+   without IFMA.  */
+static bool testSqr (void) {
+  Random random;
+  uint64_t a[IFMA_MAX_CELLS];
+  uint64_t dst[2 * IFMA_MAX_CELLS];
+  uint64_t scalar[2 * IFMA_MAX_CELLS];
+  uint64_t expected[2 * IFMA_MAX_CELLS];
+
+  const int max = 2000;
+  ErrorExamples errorExamples ("Error for: n=%ld, i=%ld.\n");
+  ProgressionBar::init ("Ifma::sqr", max);
+  if (!ifmaAvailable ())
+    return false;
+  for (int i = 0; i < max; ++i) {
+    const int n = i < 64 ? i + 1 : random.nextInt (IFMA_MAX_CELLS) + 1;
+    setRandomCells (a, random, n);
+
+    Ifma::sqr (dst, a, n);
+    Ifma::setActive (false);
+    Limbs::sqrBasecase (scalar, a, n);
+    Ifma::setActive (true);
+    referenceMul (expected, a, n, a, n);
+    bool error = memcmp (dst, expected, 2 * n << 3) != 0 || memcmp (scalar, expected, 2 * n << 3) != 0;
+    if (error) {
+      errorExamples.add (n, (int64_t) i);
+    }
+    ProgressionBar::update (error);
+  }
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Compares the products and squares of IntegerOps with IFMA turned on and
+   off, for operands around the IFMA thresholds and blocks.  */
+static bool testIntegerOps (void) {
+  Random random;
+  IntegerOps ops (200);
+  Integer bigintA = ops.createInteger ();
+  Integer bigintB = ops.createInteger ();
+  uint64_t cells[100];
+
+  const int max = 1000;
+  ErrorExamples errorExamples ("Error for: an=%ld, bn=%ld.\n");
+  ProgressionBar::init ("IntegerOps::mul, IntegerOps::sqr [IFMA]", max);
+  for (int i = 0; i < max; ++i) {
+    const int an = random.nextInt (100) + 1;
+    const int bn = random.nextInt (30) + 1;
+    setRandomCells (cells, random, an);
+    cells[an - 1] |= 1;
+    bigintA = IntegerView (cells, an, random.nextInt (2) == 1);
+    setRandomCells (cells, random, bn);
+    cells[bn - 1] |= 1;
+    bigintB = IntegerView (cells, bn, random.nextInt (2) == 1);
+
+    IntegerOps::setIfma (true);
+    const Integer product = ops.mul (bigintA, bigintB);
+    const Integer square = ops.sqr (bigintB);
+    IntegerOps::setIfma (false);
+    bool error = product != ops.mul (bigintA, bigintB);
+    error |= square != ops.sqr (bigintB);
+    if (error) {
+      errorExamples.add (an, (int64_t) bn);
+    }
+    ProgressionBar::update (error);
+  }
+  IntegerOps::setIfma (true);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+const test_fn_t ifmaTests[] = {
+  testMul,
+  testMulBasecase,
+  testSqr,
+  testIntegerOps
+};
@@ -0,0 +1,202 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <string.h>
+#include <skylge/testutils/ErrorExamples.h>
+#include <skylge/testutils/progressionBar.h>
+#include <skylge/testutils/Random.h>
+#include "cells.h"
+#include "kernels.h"
+#include "kernelsTests.h"
+
+/* Each kernel is run for all lengths up to MAX_LENGTH, in the portable
+   version and, if the processor has ADX and BMI2, in the assembly one.  */
+#define MAX_LENGTH 40
+#define TRIALS 40
+
+/* Offsets of the destination of the shifts from the source.  */
+#define MAX_OVERLAP 3
+
+/* Selects the version of the kernels for run (0 portable, 1 ADX); returns
+   false, after saying so, if it is not available.  */
+static bool selectVersion (int run) {
+  const bool adx = Kernels::setAdx (run == 1);
+  if (run == 1 && !adx) {
+    printf ("The processor does not have ADX and BMI2; assembly kernels skipped.\n");
+  }
+  return adx == (run == 1);
+}
+
+static uint64_t randomMultiplier (Random& random) {
+  const int kind = random.nextInt (5);
+  return kind == 0 ? 0 : kind == 1 ? 1 : kind == 2 ? (uint64_t) -1 : (uint64_t) random.bits (64);
+}
+
+/* Checks add and sub, also with the result in place of either operand.  */
+static bool testAddSub (void) {
+  Random random;
+  uint64_t a[MAX_LENGTH];
+  uint64_t b[MAX_LENGTH];
+  uint64_t dst[MAX_LENGTH];
+  uint64_t sum[MAX_LENGTH];
+  uint64_t difference[MAX_LENGTH];
+
+  ErrorExamples errorExamples ("Error for: adx=%ld, n=%ld.\n");
+  ProgressionBar::init ("Kernels::add, Kernels::sub", 2 * (MAX_LENGTH + 1));
+  for (int run = 0; run < 2; ++run) {
+    const bool selected = selectVersion (run);
+    for (int n = 0; n <= MAX_LENGTH; ++n) {
+      bool error = false;
+      for (int t = 0; selected && t < TRIALS && !error; ++t) {
+        setRandomCells (a, random, n);
+        setRandomCells (b, random, n);
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+          const unsigned __int128 s = (unsigned __int128) a[i] + b[i] + carry;
+          sum[i] = (uint64_t) s;
+          carry = (uint64_t) (s >> 64);
+          const unsigned __int128 d = (unsigned __int128) a[i] - b[i] - borrow;
+          difference[i] = (uint64_t) d;
+          borrow = (uint64_t) (d >> 64) & 1;
+        }
+
+        error = Kernels::add (dst, a, b, n) != carry || memcmp (dst, sum, n << 3) != 0;
+        error |= Kernels::sub (dst, a, b, n) != borrow || memcmp (dst, difference, n << 3) != 0;
+        memcpy (dst, a, n << 3);
+        error |= Kernels::add (dst, dst, b, n) != carry || memcmp (dst, sum, n << 3) != 0;
+        memcpy (dst, b, n << 3);
+        error |= Kernels::sub (dst, a, dst, n) != borrow || memcmp (dst, difference, n << 3) != 0;
+      }
+      if (error) {
+        errorExamples.add ((int64_t) run, (int64_t) n);
+      }
+      ProgressionBar::update (error);
+    }
+  }
+  Kernels::setAdx (true);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Checks mul1, also in place, addMul1 and subMul1.  */
+static bool testMul1 (void) {
+  Random random;
+  uint64_t src[MAX_LENGTH];
+  uint64_t dst[MAX_LENGTH];
+  uint64_t original[MAX_LENGTH];
+  uint64_t product[MAX_LENGTH + 1];
+  uint64_t expected[MAX_LENGTH];
+
+  ErrorExamples errorExamples ("Error for: adx=%ld, n=%ld.\n");
+  ProgressionBar::init ("Kernels::mul1, Kernels::addMul1, Kernels::subMul1", 2 * (MAX_LENGTH + 1));
+  for (int run = 0; run < 2; ++run) {
+    const bool selected = selectVersion (run);
+    for (int n = 0; n <= MAX_LENGTH; ++n) {
+      bool error = false;
+      for (int t = 0; selected && t < TRIALS && !error; ++t) {
+        setRandomCells (src, random, n);
+        setRandomCells (original, random, n);
+        const uint64_t m = randomMultiplier (random);
+        referenceMul (product, src, n, &m, 1);
+
+        error = Kernels::mul1 (dst, src, n, m) != product[n] || memcmp (dst, product, n << 3) != 0;
+        memcpy (dst, src, n << 3);
+        error |= Kernels::mul1 (dst, dst, n, m) != product[n] || memcmp (dst, product, n << 3) != 0;
+
+        uint64_t carry = 0;
+        uint64_t borrow = 0;
+        for (int i = 0; i < n; ++i) {
+          const unsigned __int128 s = (unsigned __int128) original[i] + product[i] + carry;
+          expected[i] = (uint64_t) s;
+          carry = (uint64_t) (s >> 64);
+        }
+        memcpy (dst, original, n << 3);
+        error |= Kernels::addMul1 (dst, src, n, m) != product[n] + carry || memcmp (dst, expected, n << 3) != 0;
+
+        for (int i = 0; i < n; ++i) {
+          const unsigned __int128 d = (unsigned __int128) original[i] - product[i] - borrow;
+          expected[i] = (uint64_t) d;
+          borrow = (uint64_t) (d >> 64) & 1;
+        }
+        memcpy (dst, original, n << 3);
+        error |= Kernels::subMul1 (dst, src, n, m) != product[n] + borrow || memcmp (dst, expected, n << 3) != 0;
+      }
+      if (error) {
+        errorExamples.add ((int64_t) run, (int64_t) n);
+      }
+      ProgressionBar::update (error);
+    }
+  }
+  Kernels::setAdx (true);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+/* Checks shl and shr, with the destination at the source or overlapping it
+   as far as allowed: above the source for shl and below it for shr.  */
+static bool testShifts (void) {
+  Random random;
+  uint64_t src[MAX_LENGTH];
+  uint64_t expected[MAX_LENGTH];
+  uint64_t buf[MAX_LENGTH + 2 * MAX_OVERLAP];
+
+  ErrorExamples errorExamples ("Error for: adx=%ld, n=%ld.\n");
+  ProgressionBar::init ("Kernels::shl, Kernels::shr", 2 * MAX_LENGTH);
+  for (int run = 0; run < 2; ++run) {
+    const bool selected = selectVersion (run);
+    for (int n = 1; n <= MAX_LENGTH; ++n) {
+      bool error = false;
+      for (int t = 0; selected && t < TRIALS && !error; ++t) {
+        setRandomCells (src, random, n);
+        const int bits = t < 8 ? (t < 4 ? t + 1 : 64 - t + 3) : random.nextInt (63) + 1;
+        const int overlap = t % (MAX_OVERLAP + 1);
+
+        for (int i = 0; i < n; ++i) {
+          expected[i] = src[i] << bits | (i > 0 ? src[i - 1] >> 64 - bits : 0);
+        }
+        uint64_t* s = buf + MAX_OVERLAP;
+        memcpy (s, src, n << 3);
+        const uint64_t out = Kernels::shl (s + overlap, s, n, bits);
+        error = out != src[n - 1] >> 64 - bits || memcmp (s + overlap, expected, n << 3) != 0;
+
+        for (int i = 0; i < n; ++i) {
+          expected[i] = src[i] >> bits | (i < n - 1 ? src[i + 1] << 64 - bits : 0);
+        }
+        memcpy (s, src, n << 3);
+        Kernels::shr (s - overlap, s, n, bits);
+        error |= memcmp (s - overlap, expected, n << 3) != 0;
+      }
+      if (error) {
+        errorExamples.add ((int64_t) run, (int64_t) n);
+      }
+      ProgressionBar::update (error);
+    }
+  }
+  Kernels::setAdx (true);
+  errorExamples.print ();
+  return !errorExamples.empty ();
+}
+
+const test_fn_t kernelsTests[] = {
+  testAddSub,
+  testMul1,
+  testShifts
+};
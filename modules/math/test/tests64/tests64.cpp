@@ -0,0 +1,32 @@
+/*
+   Author:  Gerard Visser
+   e-mail:  visser.gerard(at)gmail.com
+
+   Copyright (C) 2019 Gerard Visser.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <skylge/testutils/testRunner.h>
+#include "ifmaTests.h"
+#include "integerOpsTests.h"
+#include "integerTests.h"
+#include "kernelsTests.h"
+
+int main (int argc, char** args, char** env) {
+  RUN_TESTS (kernelsTests);
+  RUN_TESTS (ifmaTests);
+  RUN_TESTS (integerTests);
+  RUN_TESTS (integerOpsTests);
+  return 0;
+}